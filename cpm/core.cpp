@@ -1,5 +1,13 @@
 #include "core.h"
 
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
 namespace cpm
 {
   SolutionData::SolutionData(const std::vector<double>& vals, double objVal)
@@ -8,8 +16,17 @@ namespace cpm
 
   }
 
+  OracleStatistics::OracleStatistics(double budget)
+    : numCalls(0), numSkips(0), numSuccesses(0), numCuts(0), time(0.0), violation(0.0), timeBudget(budget)
+  {
+
+  }
+
   Core::Core(Solver* solver)
-    : _solver(solver), _bestSolution(nullptr)
+    : _solver(solver), _adaptiveScheduling(true), _random(0), _bestSolution(nullptr), _gapLimit(0.0),
+      _primalBound(-std::numeric_limits<double>::min()), _dualBound(std::numeric_limits<double>::max()), _verbose(true), _storeInequalities(false),
+      _asynchronous(false), _asynchronousMinCuts(1), _numRounds(0), _numInequalities(0), _unproven(false), _numInactive(0),
+      _activationBatchSize(0)
   {
 
   }
@@ -21,12 +38,748 @@ namespace cpm
 
   std::size_t Core::addVariable(const std::string& name, double objective, double lowerBound, double upperBound)
   {
+    _lowerBounds.push_back(lowerBound);
+    _upperBounds.push_back(upperBound);
+    _inactive.push_back(false);
+    _solutions.clear();
+    _bestSolution = nullptr;
     return _solver->addVariable(name, objective, lowerBound, upperBound);
   }
 
-  void Core::addOracle(SeparationOracle* oracle)
+  std::size_t Core::addVariables(std::size_t count, const double* objective, const double* lowerBounds, const double* upperBounds,
+    const std::string* names)
+  {
+    _lowerBounds.insert(_lowerBounds.end(), lowerBounds, lowerBounds + count);
+    _upperBounds.insert(_upperBounds.end(), upperBounds, upperBounds + count);
+    _inactive.resize(_inactive.size() + count, false);
+    _solutions.clear();
+    _bestSolution = nullptr;
+    return _solver->addVariables(count, objective, lowerBounds, upperBounds, names);
+  }
+
+  void Core::changeObjective(std::size_t variable, double objective)
+  {
+    _solver->changeObjective(variable, objective);
+    _solutions.clear();
+    _bestSolution = nullptr;
+  }
+
+  void Core::changeBounds(std::size_t variable, double lowerBound, double upperBound)
+  {
+    // Inactive variables stay fixed to 0 and get the new bounds when activated.
+
+    _lowerBounds[variable] = lowerBound;
+    _upperBounds[variable] = upperBound;
+    if (!_inactive[variable])
+      _solver->changeBounds(variable, lowerBound, upperBound);
+    _solutions.clear();
+    _bestSolution = nullptr;
+  }
+
+  void Core::setActiveVariables(const std::vector<std::size_t>& variables, std::size_t batchSize)
+  {
+    std::vector<bool> active(_solver->numVariables(), false);
+    for (std::size_t i = 0; i < variables.size(); ++i)
+      active[variables[i]] = true;
+    for (std::size_t v = 0; v < active.size(); ++v)
+    {
+      if (!active[v] && (_lowerBounds[v] > 0.0 || _upperBounds[v] < 0.0))
+        throw std::runtime_error("Core: Only variables whose bounds admit 0 can be inactive.");
+    }
+
+    _activationBatchSize = std::max<std::size_t>(batchSize, 1);
+    _numInactive = 0;
+    for (std::size_t v = 0; v < active.size(); ++v)
+    {
+      if (active[v] == _inactive[v])
+      {
+        if (active[v])
+          _solver->changeBounds(v, _lowerBounds[v], _upperBounds[v]);
+        else
+          _solver->changeBounds(v, 0.0, 0.0);
+      }
+      _inactive[v] = !active[v];
+      if (_inactive[v])
+        ++_numInactive;
+    }
+  }
+
+  bool Core::gapClosed() const
+  {
+    return _primalBound > 0.0 && _dualBound < std::numeric_limits<double>::infinity()
+      && _dualBound - _primalBound <= _gapLimit * _dualBound;
+  }
+
+  double Core::priceInactiveVariables(double lpValue, std::vector<std::size_t>& candidates) const
+  {
+    // Let y be the dual multipliers of the rows, R their part of the dual objective and d = c - A^T y the reduced costs. Scaling y by
+    // t in [0, 1] keeps it dual feasible and turns the reduced costs into d(t) = (1 - t) c + t d, so for every such t the LP of all
+    // variables is bounded by g(t) = t R + sum_v max(d_v(t) u_v, d_v(t) l_v), where inactive variables get their actual bounds. Thus
+    // g(1) extends the current dual solution by the reduced costs of the inactive variables, which is infinite if one of them has
+    // d_v < 0 and l_v = -inf, while g(0) is the maximum of the objective subject to the bounds only. g is convex and piecewise linear
+    // with breaks where some d_v(t) changes its sign, so its minimum is found by sweeping over these in increasing order.
+
+    candidates.clear();
+    const double infinity = std::numeric_limits<double>::infinity();
+    const std::vector<double>& reducedCosts = _solver->reducedCosts();
+    bool hasReducedCosts = reducedCosts.size() == _inactive.size();
+    std::vector<double> objective(_inactive.size());
+    std::vector<double> costs(_inactive.size(), 0.0);
+    double rowBound = lpValue;
+    double value = 0.0;
+    double slope = 0.0;
+    std::vector<std::pair<double, std::size_t> > breaks;
+    for (std::size_t v = 0; v < _inactive.size(); ++v)
+    {
+      double c = _solver->objectiveCoefficient(v);
+      objective[v] = c;
+      if (c > 0.0)
+        value += c * _upperBounds[v];
+      else if (c < 0.0)
+        value += c * _lowerBounds[v];
+      if (!hasReducedCosts)
+        continue;
+
+      // The dual objective of the restricted LP is its value, so R is the value minus the bound terms of the active variables.
+
+      double d = std::fabs(reducedCosts[v]) > 1.0e-9 ? reducedCosts[v] : 0.0;
+      costs[v] = d;
+      if (!_inactive[v] && d > 0.0)
+        rowBound -= d * _upperBounds[v];
+      else if (!_inactive[v] && d < 0.0)
+        rowBound -= d * _lowerBounds[v];
+      if (_inactive[v] && d != 0.0)
+        candidates.push_back(v);
+
+      double delta = d - c;
+      if (delta == 0.0)
+        continue;
+      bool positive = c > 0.0 || (c == 0.0 && delta > 0.0);
+      slope += delta * (positive ? _upperBounds[v] : _lowerBounds[v]);
+      if ((c > 0.0 && d < 0.0) || (c < 0.0 && d > 0.0))
+        breaks.push_back(std::make_pair(c / (c - d), v));
+    }
+
+    // Without reduced costs or with a dual solution that is not finite, only g(0) is available.
+
+    double scaling = 0.0;
+    if (hasReducedCosts && value < infinity && std::fabs(rowBound) < infinity)
+    {
+      slope += rowBound;
+      std::sort(breaks.begin(), breaks.end());
+      for (std::size_t b = 0; b < breaks.size() && slope < 0.0; ++b)
+      {
+        value += slope * (breaks[b].first - scaling);
+        scaling = breaks[b].first;
+        std::size_t v = breaks[b].second;
+        double delta = costs[v] - objective[v];
+        slope += objective[v] > 0.0 ? delta * (_lowerBounds[v] - _upperBounds[v]) : delta * (_upperBounds[v] - _lowerBounds[v]);
+      }
+      if (slope < 0.0)
+      {
+        value += slope * (1.0 - scaling);
+        scaling = 1.0;
+      }
+    }
+    else if (hasReducedCosts && value == infinity)
+    {
+      scaling = 1.0;
+      value = rowBound;
+      for (std::size_t v = 0; v < _inactive.size(); ++v)
+      {
+        if (costs[v] > 0.0)
+          value += costs[v] * _upperBounds[v];
+        else if (costs[v] < 0.0)
+          value += costs[v] * _lowerBounds[v];
+      }
+    }
+
+    // The potential of an inactive variable is its term in the minimizing g, i.e., what the bound charges for keeping it inactive.
+    // Without reduced costs, all inactive variables are candidates.
+
+    if (!hasReducedCosts)
+    {
+      for (std::size_t v = 0; v < _inactive.size(); ++v)
+      {
+        if (_inactive[v])
+          candidates.push_back(v);
+      }
+      return candidates.empty() ? lpValue : std::max(lpValue, value);
+    }
+
+    std::vector<double> potentials(_inactive.size(), 0.0);
+    for (std::size_t i = 0; i < candidates.size(); ++i)
+    {
+      std::size_t v = candidates[i];
+      double cost = (1.0 - scaling) * objective[v] + scaling * costs[v];
+      if (cost > 0.0)
+        potentials[v] = cost * _upperBounds[v];
+      else if (cost < 0.0)
+        potentials[v] = cost * _lowerBounds[v];
+    }
+    std::sort(candidates.begin(), candidates.end(), [&potentials, &costs](std::size_t a, std::size_t b)
+      {
+        if (potentials[a] != potentials[b])
+          return potentials[a] > potentials[b];
+        return std::fabs(costs[a]) > std::fabs(costs[b]);
+      });
+    return std::max(lpValue, value);
+  }
+
+  void Core::activateVariables(const std::vector<std::size_t>& candidates)
+  {
+    std::size_t numActivated = std::min(candidates.size(), _activationBatchSize);
+    for (std::size_t i = 0; i < numActivated; ++i)
+    {
+      std::size_t v = candidates[i];
+      _solver->changeBounds(v, _lowerBounds[v], _upperBounds[v]);
+      _inactive[v] = false;
+    }
+    _numInactive -= numActivated;
+    if (_verbose)
+    {
+      std::cerr << elapsedTime() << ": Activated " << numActivated << " variables, " << _numInactive << " remain inactive." << std::endl;
+    }
+  }
+
+  void Core::setNameGenerator(const Solver::NameGenerator& generator)
+  {
+    _solver->setNameGenerator(generator);
+  }
+
+  void Core::addOracle(SeparationOracle* oracle, double timeBudget)
   {
     _oracles.push_back(oracle);
+    _oracleStatistics.push_back(OracleStatistics(timeBudget));
+  }
+
+  void Core::replaceOracle(std::size_t oracle, SeparationOracle* replacement)
+  {
+    _oracles[oracle] = replacement;
+  }
+
+  void Core::addHeuristic(PrimalHeuristic* heuristic)
+  {
+    _heuristics.push_back(heuristic);
+  }
+
+  void Core::replaceHeuristic(std::size_t heuristic, PrimalHeuristic* replacement)
+  {
+    _heuristics[heuristic] = replacement;
+  }
+
+  void Core::setGapLimit(double relativeGap)
+  {
+    _gapLimit = relativeGap;
+  }
+
+  void Core::setAdaptiveScheduling(bool adaptive)
+  {
+    _adaptiveScheduling = adaptive;
+  }
+
+  void Core::setVerbose(bool verbose)
+  {
+    _verbose = verbose;
+    _solver->setVerbose(verbose);
+  }
+
+  void Core::setProgressCallback(const ProgressCallback& callback)
+  {
+    _progressCallback = callback;
+  }
+
+  void Core::setStoreInequalities(bool store)
+  {
+    _storeInequalities = store;
+  }
+
+  void Core::setAsynchronous(bool asynchronous, std::size_t minCuts)
+  {
+    _asynchronous = asynchronous;
+    _asynchronousMinCuts = std::max<std::size_t>(minCuts, 1);
+  }
+
+  void Core::addInequalities(std::vector<double>& lhs, std::vector<double>& rhs, std::vector<std::size_t>& begin,
+    std::vector<std::size_t>& indices, std::vector<double>& values)
+  {
+    if (_storeInequalities)
+    {
+      for (std::size_t i = 0; i < lhs.size(); ++i)
+      {
+        std::size_t first = begin[i];
+        std::size_t beyond = (i+1 < lhs.size()) ? begin[i+1] : indices.size();
+        Inequality inequality;
+        inequality.lhs = lhs[i];
+        inequality.rhs = rhs[i];
+        inequality.indices.assign(indices.begin() + first, indices.begin() + beyond);
+        inequality.values.assign(values.begin() + first, values.begin() + beyond);
+        _inequalities.push_back(inequality);
+      }
+    }
+    _numInequalities += lhs.size();
+    _solver->addInequalities(lhs, rhs, begin, indices, values);
+  }
+
+  void Core::setRectangleExpander(const RectangleExpander& expander)
+  {
+    _rectangleExpander = expander;
+  }
+
+  std::size_t Core::addRectangles(const std::vector<Rectangle>& rectangles)
+  {
+    if (!_rectangleExpander)
+      throw std::runtime_error("Core: Rectangles require a rectangle expander.");
+
+    // Rectangles are only expanded here, right before they reach the solver.
+
+    std::vector<double> lhs;
+    std::vector<double> rhs;
+    std::vector<std::size_t> begin;
+    std::vector<std::size_t> indices;
+    for (std::size_t i = 0; i < rectangles.size(); ++i)
+    {
+      // The pool keeps each rectangle once, but repeated ones still reach the solver, which may need them, e.g., as best responses.
+      // Rectangles with equal hashes are compared in full.
+
+      if (_storeInequalities)
+      {
+        std::uint64_t hash = rectangles[i].hash();
+        bool stored = false;
+        typedef std::unordered_multimap<std::uint64_t, std::size_t>::const_iterator Iterator;
+        std::pair<Iterator, Iterator> range = _rectangleIndices.equal_range(hash);
+        for (Iterator iter = range.first; iter != range.second && !stored; ++iter)
+          stored = _rectangles[iter->second] == rectangles[i];
+        if (!stored)
+        {
+          _rectangleIndices.insert(std::make_pair(hash, _rectangles.size()));
+          _rectangles.push_back(rectangles[i]);
+        }
+      }
+      lhs.push_back(-std::numeric_limits<double>::infinity());
+      rhs.push_back(1.0);
+      begin.push_back(indices.size());
+      _rectangleExpander(rectangles[i], indices);
+    }
+    if (lhs.empty())
+      return 0;
+
+    std::vector<double> values(indices.size(), 1.0);
+    _numInequalities += lhs.size();
+    _solver->addInequalities(lhs, rhs, begin, indices, values);
+    return lhs.size();
+  }
+
+  double Core::elapsedTime() const
+  {
+    return std::chrono::duration_cast<std::chrono::duration<double> >(std::chrono::steady_clock::now() - _timeStart).count();
+  }
+
+  double Core::oracleScore(std::size_t oracle) const
+  {
+    // Expected violation found per second, with a Laplace prior on the success rate.
+
+    const OracleStatistics& stats = _oracleStatistics[oracle];
+    double successRate = (stats.numSuccesses + 1.0) / (stats.numCalls + 2.0);
+    double meanViolation = stats.numSuccesses > 0 ? stats.violation / stats.numSuccesses : 0.0;
+    double meanTime = stats.time / stats.numCalls + 1.0e-6;
+    return successRate * (1.0 + meanViolation) / meanTime;
+  }
+
+  void Core::scheduleOracles(std::vector<std::size_t>& order) const
+  {
+    // The priority is the primary key. In adaptive mode, the relative score of an oracle may move it by at most one priority level.
+
+    std::vector<double> keys(_oracles.size());
+    double logMeanScore = 0.0;
+    std::size_t numScored = 0;
+    for (std::size_t o = 0; o < _oracles.size(); ++o)
+    {
+      if (_oracleStatistics[o].numCalls > 0)
+      {
+        logMeanScore += std::log(oracleScore(o));
+        ++numScored;
+      }
+    }
+    if (numScored > 0)
+      logMeanScore /= numScored;
+    for (std::size_t o = 0; o < _oracles.size(); ++o)
+    {
+      keys[o] = _oracles[o]->priority();
+      if (_adaptiveScheduling && _oracleStatistics[o].numCalls > 0 && numScored > 1)
+        keys[o] += std::max(-1.0, std::min(1.0, (std::log(oracleScore(o)) - logMeanScore) / std::log(10.0)));
+    }
+
+    order.clear();
+    for (std::size_t o = 0; o < _oracles.size(); ++o)
+    {
+      if (!_oracleStatistics[o].exhausted())
+        order.push_back(o);
+    }
+    std::stable_sort(order.begin(), order.end(), [&keys](std::size_t a, std::size_t b) { return keys[a] > keys[b]; });
+  }
+
+  bool Core::skipOracle(std::size_t oracle)
+  {
+    // Skip with probability 1 - UCB(success rate), capped such that every oracle is still called now and then.
+
+    const OracleStatistics& stats = _oracleStatistics[oracle];
+    if (!_adaptiveScheduling || stats.numCalls < 3)
+      return false;
+
+    std::size_t totalCalls = 0;
+    for (std::size_t o = 0; o < _oracles.size(); ++o)
+      totalCalls += _oracleStatistics[o].numCalls;
+    double upperConfidence = double(stats.numSuccesses) / stats.numCalls + std::sqrt(2.0 * std::log(double(totalCalls)) / stats.numCalls);
+    double skipProbability = std::min(0.9, 1.0 - upperConfidence);
+    if (skipProbability <= 0.0)
+      return false;
+    return std::uniform_real_distribution<double>(0.0, 1.0)(_random) < skipProbability;
+  }
+
+  void Core::printOracleStatistics() const
+  {
+    for (std::size_t o = 0; o < _oracles.size(); ++o)
+    {
+      const OracleStatistics& stats = _oracleStatistics[o];
+      std::cerr << "Oracle " << o << " (priority " << _oracles[o]->priority() << "): " << stats.numCalls << " calls, " << stats.numSkips
+        << " skips, " << stats.numSuccesses << " successful, " << stats.numCuts << " cuts, " << stats.time << "s";
+      if (stats.exhausted())
+        std::cerr << ", time budget exhausted";
+      std::cerr << ".\n";
+    }
+    std::cerr << std::flush;
+  }
+
+  void Core::addSolution(const std::vector<double>& values, const char* source, std::size_t index)
+  {
+    double objVal = 0.0;
+    for (std::size_t v = 0; v < _solver->numVariables(); ++v)
+      objVal += _solver->objectiveCoefficient(v) * values[v];
+    if (_verbose)
+      std::cerr << source << " " << index << " returned a solution with objective value " <<  objVal << std::endl;
+    _solutions.push_back(std::make_shared<SolutionData>(values, objVal));
+    if (objVal > _primalBound)
+    {
+      _primalBound = objVal;
+      _bestSolution = _solutions.back();
+    }
+  }
+
+  void Core::runHeuristics()
+  {
+    std::vector<double> vals;
+    for (std::size_t h = 0; h < _heuristics.size(); ++h)
+    {
+      _heuristics[h]->run();
+      for (std::size_t p = 0; p < _heuristics[h]->numFeasiblePoints(); ++p)
+      {
+        _heuristics[h]->getFeasiblePoint(p, vals);
+        addSolution(vals, "Heuristic", h);
+      }
+    }
+    if (_verbose && !_heuristics.empty())
+      std::cerr << elapsedTime() << ": Primal bound after heuristics is " << _primalBound << "." << std::endl;
+  }
+
+  /* Interrupts an oracle once the remaining time budget of its current call has elapsed, unless the call ended before. Without it,
+   * budgets would only be checked before calls, while a single call may run for hours. */
+
+  class BudgetWatchdog
+  {
+  public:
+    BudgetWatchdog(SeparationOracle* oracle, double remainingTime)
+      : _finished(false)
+    {
+      if (remainingTime == std::numeric_limits<double>::infinity())
+        return;
+
+      std::chrono::duration<double> timeout(std::min(std::max(remainingTime, 0.0), 1.0e8));
+      _thread = std::thread([this, oracle, timeout]()
+        {
+          std::unique_lock<std::mutex> lock(_mutex);
+          if (!_changed.wait_for(lock, timeout, [this]() { return _finished; }))
+            oracle->interrupt();
+        });
+    }
+
+    ~BudgetWatchdog()
+    {
+      if (!_thread.joinable())
+        return;
+
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _finished = true;
+      }
+      _changed.notify_all();
+      _thread.join();
+    }
+
+  protected:
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    bool _finished;
+    std::thread _thread;
+  };
+
+  /* State shared between the LP thread and the oracle threads in asynchronous mode. Points are numbered starting at 1. */
+
+  struct AsynchronousState
+  {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<double> point;
+    std::size_t version;
+    bool finished;
+    std::vector<Rectangle> rectangles;
+    std::vector<Inequality> inequalities;
+    std::vector<std::size_t> busyVersion;
+    std::vector<std::size_t> doneVersion;
+    std::vector<double> violationUpperBound;
+    std::vector<std::pair<std::size_t, std::vector<double> > > solutions;
+    std::exception_ptr exception;
+
+    AsynchronousState(std::size_t numOracles)
+      : version(0), finished(false), busyVersion(numOracles, 0), doneVersion(numOracles, 0),
+      violationUpperBound(numOracles, std::numeric_limits<double>::max())
+    {
+
+    }
+  };
+
+  void Core::runAsynchronous()
+  {
+    AsynchronousState state(_oracles.size());
+
+    // Every oracle thread separates the newest point, reports streamed and returned cuts, and waits for the next point.
+
+    auto worker = [this, &state](std::size_t o)
+    {
+      SeparationOracle* oracle = _oracles[o];
+      OracleStatistics& stats = _oracleStatistics[o];
+      std::size_t numStreamed = 0;
+      oracle->setRectangleStream([&state, &numStreamed](const Rectangle& rectangle)
+        {
+          std::lock_guard<std::mutex> lock(state.mutex);
+          state.rectangles.push_back(rectangle);
+          ++numStreamed;
+          state.changed.notify_all();
+        });
+
+      std::vector<double> point, lhs, rhs, values, vals;
+      std::vector<std::size_t> begin, indices;
+      std::vector<Rectangle> rectangles;
+      std::size_t version = 0;
+      try
+      {
+        while (true)
+        {
+          {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.changed.wait(lock, [&state, version]() { return state.finished || state.version > version; });
+            if (state.finished)
+              break;
+            version = state.version;
+            point = state.point;
+            state.busyVersion[o] = version;
+
+            // Interrupts are only requested under the lock while the oracle is busy, so they refer to this generation.
+
+            oracle->beginCall();
+          }
+
+          double violationLowerBound = 0.0;
+          double violationUpperBound = std::numeric_limits<double>::max();
+          lhs.clear();
+          rhs.clear();
+          begin.clear();
+          indices.clear();
+          values.clear();
+          rectangles.clear();
+          numStreamed = 0;
+          if (!stats.exhausted())
+          {
+            std::chrono::steady_clock::time_point timeOracle = std::chrono::steady_clock::now();
+            {
+              BudgetWatchdog watchdog(oracle, stats.timeBudget - stats.time);
+              if (!_rectangleExpander || !oracle->separateRectangles(&point[0], rectangles, violationLowerBound, violationUpperBound))
+                oracle->separate(true, &point[0], lhs, rhs, begin, indices, values, violationLowerBound, violationUpperBound);
+            }
+            ++stats.numCalls;
+            stats.time += std::chrono::duration_cast<std::chrono::duration<double> >(std::chrono::steady_clock::now() - timeOracle).count();
+          }
+
+          std::lock_guard<std::mutex> lock(state.mutex);
+          std::size_t numCuts = numStreamed + rectangles.size() + lhs.size();
+          if (numCuts > 0)
+          {
+            ++stats.numSuccesses;
+            stats.numCuts += numCuts;
+            stats.violation += violationLowerBound;
+          }
+          state.rectangles.insert(state.rectangles.end(), rectangles.begin(), rectangles.end());
+          for (std::size_t i = 0; i < lhs.size(); ++i)
+          {
+            std::size_t first = begin[i];
+            std::size_t beyond = (i+1 < lhs.size()) ? begin[i+1] : indices.size();
+            Inequality inequality;
+            inequality.lhs = lhs[i];
+            inequality.rhs = rhs[i];
+            inequality.indices.assign(indices.begin() + first, indices.begin() + beyond);
+            inequality.values.assign(values.begin() + first, values.begin() + beyond);
+            state.inequalities.push_back(inequality);
+          }
+          for (std::size_t p = 0; p < oracle->numFeasiblePoints(); ++p)
+          {
+            oracle->getFeasiblePoint(p, vals);
+            state.solutions.push_back(std::make_pair(o, vals));
+          }
+          state.busyVersion[o] = 0;
+          state.doneVersion[o] = version;
+          state.violationUpperBound[o] = violationUpperBound;
+          state.changed.notify_all();
+        }
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.exception)
+          state.exception = std::current_exception();
+        state.changed.notify_all();
+      }
+      oracle->setRectangleStream(SeparationOracle::RectangleStream());
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t o = 0; o < _oracles.size(); ++o)
+      threads.push_back(std::thread(worker, o));
+    auto stopOracles = [this, &state, &threads]()
+    {
+      {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.finished = true;
+        for (std::size_t o = 0; o < _oracles.size(); ++o)
+          _oracles[o]->interrupt();
+        state.changed.notify_all();
+      }
+      for (std::size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+    };
+
+    try
+    {
+      std::vector<double> vector;
+      std::vector<Rectangle> rectangles;
+      std::vector<Inequality> inequalities;
+      std::vector<std::pair<std::size_t, std::vector<double> > > solutions;
+      bool abort = false;
+      while (!abort)
+      {
+        ++_numRounds;
+        if (_solver->run() != Solver::OPTIMAL)
+          throw std::runtime_error("Core: Asynchronous mode requires an optimal LP solution in every round.");
+
+        vector = _solver->point();
+        _dualBound = 0.0;
+        for (std::size_t v = 0; v < _solver->numVariables(); ++v)
+          _dualBound += _solver->objectiveCoefficient(v) * vector[v];
+
+        if (_verbose)
+        {
+          std::cerr << elapsedTime() << ": Dual bound is " << _dualBound << ". Primal bound is " << _primalBound << ".\n" << std::flush;
+        }
+
+        // Publish the point, interrupt oracles working on older ones and wait for enough cuts or until all oracles are done.
+
+        bool allDone = false;
+        bool proved = false;
+        {
+          std::unique_lock<std::mutex> lock(state.mutex);
+          state.point = vector;
+          ++state.version;
+          for (std::size_t o = 0; o < _oracles.size(); ++o)
+          {
+            if (state.busyVersion[o] != 0 && state.busyVersion[o] < state.version)
+              _oracles[o]->interrupt();
+          }
+          state.changed.notify_all();
+          state.changed.wait(lock, [this, &state, &allDone, &proved]()
+            {
+              allDone = true;
+              proved = false;
+              for (std::size_t o = 0; o < _oracles.size(); ++o)
+              {
+                if (state.doneVersion[o] != state.version)
+                  allDone = false;
+                else if (state.violationUpperBound[o] <= 0.0)
+                  proved = true;
+              }
+              std::size_t numQueued = state.rectangles.size() + state.inequalities.size();
+              return state.exception || numQueued >= _asynchronousMinCuts || ((allDone || proved) && numQueued == 0)
+                || (allDone && numQueued > 0);
+            });
+          if (state.exception)
+            std::rethrow_exception(state.exception);
+
+          rectangles.swap(state.rectangles);
+          inequalities.swap(state.inequalities);
+          solutions.swap(state.solutions);
+        }
+
+        for (std::size_t i = 0; i < solutions.size(); ++i)
+          addSolution(solutions[i].second, "Oracle", solutions[i].first);
+        solutions.clear();
+
+        abort = rectangles.empty() && inequalities.empty();
+        if (!rectangles.empty())
+          addRectangles(rectangles);
+        if (!inequalities.empty())
+        {
+          std::vector<double> lhs, rhs, values;
+          std::vector<std::size_t> begin, indices;
+          for (std::size_t i = 0; i < inequalities.size(); ++i)
+          {
+            lhs.push_back(inequalities[i].lhs);
+            rhs.push_back(inequalities[i].rhs);
+            begin.push_back(indices.size());
+            indices.insert(indices.end(), inequalities[i].indices.begin(), inequalities[i].indices.end());
+            values.insert(values.end(), inequalities[i].values.begin(), inequalities[i].values.end());
+          }
+          addInequalities(lhs, rhs, begin, indices, values);
+        }
+        if (_verbose)
+          std::cerr << elapsedTime() << ": Received " << (rectangles.size() + inequalities.size()) << " cuts.\n" << std::flush;
+        rectangles.clear();
+        inequalities.clear();
+
+        if (proved && abort && _dualBound > _primalBound)
+        {
+          _solutions.push_back(std::make_shared<SolutionData>(vector, _dualBound));
+          _primalBound = _dualBound;
+          _bestSolution = _solutions.back();
+        }
+
+        if (!abort && _primalBound > 0.0 && _dualBound - _primalBound <= _gapLimit * _dualBound)
+        {
+          if (_verbose)
+            std::cerr << "Relative gap " << (_dualBound - _primalBound) / _dualBound << " is within the limit." << std::endl;
+          abort = true;
+        }
+
+        if (_progressCallback)
+        {
+          Progress progress = { elapsedTime(), _numRounds, _primalBound, _dualBound, _numInequalities };
+          _progressCallback(progress);
+        }
+      }
+    }
+    catch (...)
+    {
+      stopOracles();
+      throw;
+    }
+    stopOracles();
   }
 
   void Core::run()
@@ -39,11 +792,23 @@ namespace cpm
     std::vector<std::size_t> indices;
     std::vector<double> values;
 
+    std::vector<Rectangle> rectangles;
+
     std::vector<double> vector;
     bool abort = false;
 
-    double primalBound = -std::numeric_limits<double>::min();
-    double dualBound = std::numeric_limits<double>::max();
+    _primalBound = -std::numeric_limits<double>::min();
+    _dualBound = std::numeric_limits<double>::max();
+    _numRounds = 0;
+    _unproven = false;
+    runHeuristics();
+    if (_asynchronous && _numInactive > 0)
+      throw std::runtime_error("Core: Inactive variables are not supported in asynchronous mode.");
+    if (_asynchronous)
+    {
+      runAsynchronous();
+      abort = true;
+    }
     while (!abort)
     {
       lhs.clear();
@@ -53,6 +818,7 @@ namespace cpm
       values.clear();
 
       abort = true;
+      ++_numRounds;
       Solver::Status status = _solver->run();
       if (status == Solver::OPTIMAL)
       {
@@ -61,63 +827,138 @@ namespace cpm
 
         vector = _solver->point();
         
-        dualBound = 0.0;
+        double lpValue = 0.0;
         for (std::size_t v = 0; v < _solver->numVariables(); ++v)
-          dualBound += _solver->objectiveCoefficient(v) * vector[v];
+          lpValue += _solver->objectiveCoefficient(v) * vector[v];
+        std::vector<std::size_t> activationCandidates;
+        _dualBound = lpValue;
+        if (_numInactive > 0)
+          _dualBound = priceInactiveVariables(lpValue, activationCandidates);
 
-        std::cerr << std::chrono::duration_cast<std::chrono::duration<double> >(std::chrono::steady_clock::now() - _timeStart).count()
-          << ": Dual bound is " << dualBound << ". Primal bound is " << primalBound << ".\n" << std::flush;
+        if (_verbose)
+        {
+          std::cerr << elapsedTime() << ": Dual bound is " << _dualBound << ". Primal bound is " << _primalBound << ".\n" << std::flush;
+        }
 
         // TODO: Call stabilizer to change the vector or change LP and resolve.
 
-        for (std::size_t o = 0; o < _oracles.size(); ++o)
+        // Call oracles in scheduled order until one returns cuts. Oracles skipped in the first pass are called if no cuts were found.
+
+        std::vector<std::size_t> order;
+        std::vector<std::size_t> skipped;
+        scheduleOracles(order);
+        bool proved = false;
+        for (int pass = 0; pass < 2 && abort && !proved; ++pass)
         {
-          std::size_t oldNumInequalities = lhs.size();
-          
-          _oracles[o]->separate(true, &vector[0], lhs, rhs, begin, indices, values, violationLowerBound, violationUpperBound);
-          if (violationLowerBound < 1.0e-3)
-            violationLowerBound = 0.0;
+          const std::vector<std::size_t>& candidates = (pass == 0) ? order : skipped;
+          for (std::size_t i = 0; i < candidates.size(); ++i)
+          {
+            std::size_t o = candidates[i];
+            OracleStatistics& stats = _oracleStatistics[o];
+            if (pass == 0 && skipOracle(o))
+            {
+              ++stats.numSkips;
+              skipped.push_back(o);
+              continue;
+            }
 
-          std::cout << "Oracle " << o << " returned " << (lhs.size() - oldNumInequalities) << " cuts and proved " << violationLowerBound
-            << " <= maximum cut violation";
-          if (violationUpperBound <= 0.5 * std::numeric_limits<double>::max())
-            std::cout << " <= " << violationUpperBound;
-          std::cout << ".\n" << std::flush;
+            std::size_t oldNumInequalities = lhs.size();
+            std::chrono::steady_clock::time_point timeOracle = std::chrono::steady_clock::now();
 
-          if (_oracles[o]->numFeasiblePoints() > 0)
-          {
-            // TODO: Ensure that this point is also valid w.r.t. the other oracles. For this, dominance information should be there. This helps to
-            //       avoid unnecessary calls to separation oracles. Using a sequence of the latter we might generate a sequence of infeasible points,
-            //       each being infeasible except for the last. This works if the modified-variable sets of the oracles induce an implication graph
-            //       without cycles.
+            // Rectangles are preferred since they are only expanded when they reach the solver. A call that outlasts the remaining
+            // budget of its oracle is interrupted.
+
+            rectangles.clear();
+            _oracles[o]->beginCall();
+            {
+              BudgetWatchdog watchdog(_oracles[o], stats.timeBudget - stats.time);
+              if (!_rectangleExpander || !_oracles[o]->separateRectangles(&vector[0], rectangles, violationLowerBound, violationUpperBound))
+                _oracles[o]->separate(true, &vector[0], lhs, rhs, begin, indices, values, violationLowerBound, violationUpperBound);
+            }
+            if (violationLowerBound < 1.0e-3)
+              violationLowerBound = 0.0;
+            std::size_t numNewRectangles = rectangles.empty() ? 0 : addRectangles(rectangles);
+            std::size_t numNewCuts = lhs.size() - oldNumInequalities + numNewRectangles;
+
+            ++stats.numCalls;
+            stats.time += std::chrono::duration_cast<std::chrono::duration<double> >(std::chrono::steady_clock::now() - timeOracle).count();
+            if (numNewCuts > 0)
+            {
+              ++stats.numSuccesses;
+              stats.numCuts += numNewCuts;
+              stats.violation += violationLowerBound;
+            }
+            if (stats.exhausted() && _verbose)
+              std::cerr << "Oracle " << o << " exhausted its time budget of " << stats.timeBudget << "s." << std::endl;
+
+            if (_verbose)
+            {
+              std::cout << "Oracle " << o << " returned " << numNewCuts << " cuts and proved " << violationLowerBound
+                << " <= maximum cut violation";
+              if (violationUpperBound <= 0.5 * std::numeric_limits<double>::max())
+                std::cout << " <= " << violationUpperBound;
+              std::cout << ".\n" << std::flush;
+            }
 
-            std::vector<double> vals;
-            for (std::size_t i = 0; i < _oracles[o]->numFeasiblePoints(); ++i)
+            if (_oracles[o]->numFeasiblePoints() > 0)
             {
-              _oracles[o]->getFeasiblePoint(i, vals);
-              double objVal = 0.0;
-              for (std::size_t v = 0; v < _solver->numVariables(); ++v)
-                objVal += _solver->objectiveCoefficient(v) * vals[v];
-              std::cerr << "Oracle " << o << " returned a solution with objective value " <<  objVal << std::endl;
-              _solutions.push_back(std::make_shared<SolutionData>(vals, objVal));
-              if (objVal > primalBound)
+              // TODO: Ensure that this point is also valid w.r.t. the other oracles. For this, dominance information should be there. This helps to
+              //       avoid unnecessary calls to separation oracles. Using a sequence of the latter we might generate a sequence of infeasible points,
+              //       each being infeasible except for the last. This works if the modified-variable sets of the oracles induce an implication graph
+              //       without cycles.
+
+              std::vector<double> vals;
+              for (std::size_t p = 0; p < _oracles[o]->numFeasiblePoints(); ++p)
               {
-                primalBound = objVal;
+                _oracles[o]->getFeasiblePoint(p, vals);
+                addSolution(vals, "Oracle", o);
               }
             }
-          }
 
-          if (!lhs.empty())
-          {
-            _solver->addInequalities(lhs, rhs, begin, indices, values);
-            abort = false;
-            break;
+            if (!lhs.empty() || numNewRectangles > 0)
+            {
+              if (!lhs.empty())
+                addInequalities(lhs, rhs, begin, indices, values);
+              abort = false;
+              break;
+            }
+            if (violationUpperBound <= 0.0)
+            {
+              proved = true;
+              break;
+            }
           }
-          if (violationUpperBound <= 0.0)
-            break;
+        }
+
+        if (proved && abort && lpValue > _primalBound)
+        {
+          _solutions.push_back(std::make_shared<SolutionData>(vector, lpValue));
+          _primalBound = lpValue;
+          _bestSolution = _solutions.back();
+        }
+
+        // The restricted LP is solved, so inactive variables that can improve it are activated unless the gap is already closed.
+
+        if (abort && !activationCandidates.empty() && !gapClosed())
+        {
+          activateVariables(activationCandidates);
+          abort = false;
+        }
+
+        if (!abort && gapClosed())
+        {
+          if (_verbose)
+            std::cerr << "Relative gap " << (_dualBound - _primalBound) / _dualBound << " is within the limit." << std::endl;
+          abort = true;
         }
 
         // TODO: If abort is true, then vector is feasible. Depending on stabilization it might not be optimal, though
+
+        if (_progressCallback)
+        {
+          Progress progress = { elapsedTime(), _numRounds, _primalBound, _dualBound, _numInequalities };
+          _progressCallback(progress);
+        }
       }
       else if (status == Solver::UNBOUNDED)
       {
@@ -128,12 +969,15 @@ namespace cpm
 
         // TODO: Call stabilizer to change the vector or change LP and resolve.
 
-        for (std::size_t o = 0; o < _oracles.size(); ++o)
+        std::vector<std::size_t> order;
+        scheduleOracles(order);
+        for (std::size_t i = 0; i < order.size(); ++i)
         {
+          std::size_t o = order[i];
           _oracles[o]->separate(false, &vector[0], lhs, rhs, begin, indices, values, violationLowerBound, violationUpperBound);
           if (!lhs.empty())
           {
-            _solver->addInequalities(lhs, rhs, begin, indices, values);
+            addInequalities(lhs, rhs, begin, indices, values);
             abort = false;
             break;
           }
@@ -148,9 +992,25 @@ namespace cpm
         throw std::runtime_error("Unhandled Solver::Status.");
       }
     }
+
+    // Oracles that exhausted their time budgets were not asked about the last point, so a remaining gap may not be closable.
+
+    if (!gapClosed())
+    {
+      for (std::size_t o = 0; o < _oracles.size(); ++o)
+      {
+        if (_oracleStatistics[o].exhausted())
+          _unproven = true;
+      }
+    }
+    if (_unproven && _verbose)
+      std::cerr << "Warning: Oracles exhausted their time budgets, so the final bounds are not proven to be optimal." << std::endl;
     
-    std::cerr << "Total time: " << std::chrono::duration_cast<std::chrono::duration<double> >(std::chrono::steady_clock::now() - _timeStart).count()
-      << std::endl;
+    if (_verbose)
+    {
+      printOracleStatistics();
+      std::cerr << "Total time: " << elapsedTime() << std::endl;
+    }
   }
 
 } /* namespace cpm */
\ No newline at end of file
@@ -3,9 +3,13 @@
 
 #include <memory>
 #include <chrono>
+#include <random>
+#include <functional>
+#include <unordered_map>
 
 #include "solver.h"
 #include "separation_oracle.h"
+#include "primal_heuristic.h"
 
 namespace cpm
 {
@@ -17,27 +21,257 @@ namespace cpm
     SolutionData(const std::vector<double>& values, double objectiveValue);
   };
   typedef std::shared_ptr<SolutionData> Solution;
+
+  struct Inequality
+  {
+    double lhs;
+    double rhs;
+    std::vector<std::size_t> indices;
+    std::vector<double> values;
+  };
+
+  struct OracleStatistics
+  {
+    std::size_t numCalls;
+    std::size_t numSkips;
+    std::size_t numSuccesses;
+    std::size_t numCuts;
+    double time;
+    double violation;
+    double timeBudget;
+
+    OracleStatistics(double timeBudget);
+
+    inline bool exhausted() const
+    {
+      return time >= timeBudget;
+    }
+  };
   
   class Core
   {
   public:
+    struct Progress
+    {
+      double time;
+      std::size_t round;
+      double primalBound;
+      double dualBound;
+      std::size_t numInequalities;
+    };
+    typedef std::function<void(const Progress&)> ProgressCallback;
+
     Core(Solver* solver);
 
     ~Core();
 
+    /**
+     * Adds a variable, also between runs, in which case the inequalities are kept and known solutions are discarded.
+     */
+
     std::size_t addVariable(const std::string& name, double objective, double lowerBound = -std::numeric_limits<double>::infinity(),
       double upperBound = std::numeric_limits<double>::infinity());
 
-    void addOracle(SeparationOracle* oracle);
+    /**
+     * Adds count variables at once and returns the index of the first. Without names, they are generated on demand. Like
+     * addVariable, this may be done between runs.
+     */
+
+    std::size_t addVariables(std::size_t count, const double* objective, const double* lowerBounds, const double* upperBounds,
+      const std::string* names = NULL);
+
+    void setNameGenerator(const Solver::NameGenerator& generator);
+
+    /**
+     * Change the objective coefficient or the bounds of a variable between runs. Inequalities are kept, so a subsequent run() starts
+     * from the current LP. Known solutions are discarded since they may be suboptimal or infeasible for the changed problem.
+     */
+
+    void changeObjective(std::size_t variable, double objective);
+
+    void changeBounds(std::size_t variable, double lowerBound, double upperBound);
+
+    /**
+     * Starts with only the given variables active and fixes all others to 0, so that feasible points of the restricted LP stay
+     * feasible. Whenever no more cuts are found, up to batchSize inactive variables are activated, those of largest potential first.
+     * The dual bound extends the dual solution of the restricted LP to all variables after scaling its row multipliers by the factor
+     * in [0, 1] that minimizes the bound. A factor of 1 adds the gains the reduced costs promise within the bounds, which is infinite
+     * for a negative reduced cost and lower bound -inf, and a factor of 0 yields the maximum of the objective subject to the bounds
+     * only. The potential of a variable is its gain for the minimizing factor. Not available in asynchronous mode.
+     */
+
+    void setActiveVariables(const std::vector<std::size_t>& variables, std::size_t batchSize);
+
+    inline std::size_t numActiveVariables() const
+    {
+      return _solver->numVariables() - _numInactive;
+    }
+
+    inline bool isActive(std::size_t variable) const
+    {
+      return !_inactive[variable];
+    }
+
+    /**
+     * Adds an oracle that is no longer called once its calls took timeBudget seconds in total. A call that outlasts the remaining
+     * budget is interrupted.
+     */
+
+    void addOracle(SeparationOracle* oracle, double timeBudget = std::numeric_limits<double>::infinity());
+
+    /**
+     * Replaces an oracle between runs, e.g., by one that knows about added variables. Its statistics and time budget are kept.
+     */
+
+    void replaceOracle(std::size_t oracle, SeparationOracle* replacement);
+
+    void addHeuristic(PrimalHeuristic* heuristic);
+
+    void replaceHeuristic(std::size_t heuristic, PrimalHeuristic* replacement);
+
+    void setGapLimit(double relativeGap);
+
+    void setAdaptiveScheduling(bool adaptive);
+
+    void setVerbose(bool verbose);
+
+    void setProgressCallback(const ProgressCallback& callback);
+
+    void setStoreInequalities(bool store);
+
+    /**
+     * In asynchronous mode, every oracle runs on its own thread and always separates the latest LP point. The LP is re-solved as
+     * soon as minCuts cuts have arrived, and oracles still working on an older point are interrupted. Oracle scheduling is not used.
+     * The solver must find an optimal solution of every LP, and oracles must support beginCall() and interrupt() from other threads.
+     */
+
+    void setAsynchronous(bool asynchronous, std::size_t minCuts = 1);
+
+    void addInequalities(std::vector<double>& lhs, std::vector<double>& rhs, std::vector<std::size_t>& begin,
+      std::vector<std::size_t>& indices, std::vector<double>& values);
+
+    /**
+     * Sets the expander that maps rectangles to variables. Without one, oracles are only asked for CSR inequalities.
+     */
+
+    void setRectangleExpander(const RectangleExpander& expander);
+
+    /**
+     * Adds rectangles, which requires a rectangle expander. If inequalities are stored, each distinct rectangle is kept once.
+     * Returns the number of rectangles added.
+     */
+
+    std::size_t addRectangles(const std::vector<Rectangle>& rectangles);
 
     void run();
 
+    inline double primalBound() const
+    {
+      return _primalBound;
+    }
+
+    inline double dualBound() const
+    {
+      return _dualBound;
+    }
+
+    /**
+     * Whether the last run ended with a gap while some oracles had exhausted their time budgets. Both bounds are valid, but the LP
+     * optimum is not proven to be attained.
+     */
+
+    inline bool unproven() const
+    {
+      return _unproven;
+    }
+
+    inline const Solution& bestSolution() const
+    {
+      return _bestSolution;
+    }
+
+    inline std::size_t numRounds() const
+    {
+      return _numRounds;
+    }
+
+    inline std::size_t numInequalities() const
+    {
+      return _numInequalities;
+    }
+
+    inline const std::vector<Inequality>& inequalities() const
+    {
+      return _inequalities;
+    }
+
+    inline const std::vector<Rectangle>& rectangles() const
+    {
+      return _rectangles;
+    }
+
+    inline std::size_t numOracles() const
+    {
+      return _oracles.size();
+    }
+
+    inline const OracleStatistics& oracleStatistics(std::size_t oracle) const
+    {
+      return _oracleStatistics[oracle];
+    }
+
   protected:
+    double elapsedTime() const;
+
+    double oracleScore(std::size_t oracle) const;
+
+    void scheduleOracles(std::vector<std::size_t>& order) const;
+
+    bool skipOracle(std::size_t oracle);
+
+    void printOracleStatistics() const;
+
+    void addSolution(const std::vector<double>& values, const char* source, std::size_t index);
+
+    void runHeuristics();
+
+    void runAsynchronous();
+
+    bool gapClosed() const;
+
+    double priceInactiveVariables(double lpValue, std::vector<std::size_t>& candidates) const;
+
+    void activateVariables(const std::vector<std::size_t>& candidates);
+
     Solver* _solver;
     std::vector<SeparationOracle*> _oracles;
+    std::vector<OracleStatistics> _oracleStatistics;
+    std::vector<PrimalHeuristic*> _heuristics;
+    bool _adaptiveScheduling;
+    std::mt19937 _random;
     std::vector<Solution> _solutions;
     Solution _bestSolution;
     std::chrono::steady_clock::time_point _timeStart; 
+    double _gapLimit;
+    double _primalBound;
+    double _dualBound;
+    bool _verbose;
+    bool _storeInequalities;
+    bool _asynchronous;
+    std::size_t _asynchronousMinCuts;
+    ProgressCallback _progressCallback;
+    std::size_t _numRounds;
+    std::size_t _numInequalities;
+    std::vector<Inequality> _inequalities;
+    bool _unproven;
+    RectangleExpander _rectangleExpander;
+    std::unordered_multimap<std::uint64_t, std::size_t> _rectangleIndices;
+    std::vector<Rectangle> _rectangles;
+    std::vector<double> _lowerBounds;
+    std::vector<double> _upperBounds;
+    std::vector<bool> _inactive;
+    std::size_t _numInactive;
+    std::size_t _activationBatchSize;
   };
 
 }
@@ -0,0 +1,17 @@
+#include "primal_heuristic.h"
+
+namespace cpm
+{
+
+  PrimalHeuristic::PrimalHeuristic(std::size_t ambientDimension)
+    : _ambientDimension(ambientDimension)
+  {
+
+  }
+
+  PrimalHeuristic::~PrimalHeuristic()
+  {
+
+  }
+
+} /* namespace cpm */
@@ -0,0 +1,37 @@
+#ifndef _PRIMAL_HEURISTIC_H_
+#define _PRIMAL_HEURISTIC_H_
+
+#include <vector>
+
+namespace cpm
+{
+
+  /**
+   * Produces feasible points without looking at the LP. Core runs all heuristics once before the first round.
+   */
+
+  class PrimalHeuristic
+  {
+  protected:
+    std::size_t _ambientDimension;
+
+  public:
+    PrimalHeuristic(std::size_t ambientDimension);
+
+    virtual ~PrimalHeuristic();
+
+    inline std::size_t ambientDimension() const
+    {
+      return _ambientDimension;
+    }
+
+    virtual void run() = 0;
+
+    virtual std::size_t numFeasiblePoints() const = 0;
+
+    virtual void getFeasiblePoint(std::size_t id, std::vector<double>& point) const = 0;
+  };
+
+} /* namespace cpm */
+
+#endif /* _PRIMAL_HEURISTIC_H_ */
@@ -0,0 +1,30 @@
+#include "rectangle.h"
+
+#include <algorithm>
+
+namespace cpm
+{
+
+  void Rectangle::normalize()
+  {
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    std::sort(columns.begin(), columns.end());
+    columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+  }
+
+  std::uint64_t Rectangle::hash() const
+  {
+    // FNV-1a over both sizes and all ids.
+
+    std::uint64_t result = 14695981039346656037ULL;
+    result = (result ^ rows.size()) * 1099511628211ULL;
+    for (std::size_t i = 0; i < rows.size(); ++i)
+      result = (result ^ rows[i]) * 1099511628211ULL;
+    result = (result ^ columns.size()) * 1099511628211ULL;
+    for (std::size_t i = 0; i < columns.size(); ++i)
+      result = (result ^ columns[i]) * 1099511628211ULL;
+    return result;
+  }
+
+} /* namespace cpm */
@@ -0,0 +1,44 @@
+#ifndef _RECTANGLE_H_
+#define _RECTANGLE_H_
+
+#include <cstdint>
+#include <vector>
+#include <functional>
+
+namespace cpm
+{
+
+  /**
+   * Compact form of the inequality sum of x_(r,c) over all r in rows and c in columns <= 1, where variables are indexed by pairs.
+   * Rows and columns are sorted and free of duplicates. The variable indices are only produced by a RectangleExpander.
+   */
+
+  struct Rectangle
+  {
+    std::vector<std::uint32_t> rows;
+    std::vector<std::uint32_t> columns;
+
+    void normalize();
+
+    std::uint64_t hash() const;
+
+    inline std::size_t size() const
+    {
+      return rows.size() * columns.size();
+    }
+
+    inline bool operator==(const Rectangle& other) const
+    {
+      return rows == other.rows && columns == other.columns;
+    }
+  };
+
+  /**
+   * Appends the indices of all variables of the rectangle.
+   */
+
+  typedef std::function<void(const Rectangle& rectangle, std::vector<std::size_t>& indices)> RectangleExpander;
+
+} /* namespace cpm */
+
+#endif /* _RECTANGLE_H_ */
@@ -7,7 +7,7 @@ namespace cpm
 {
  
   SeparationOracle::SeparationOracle(std::size_t ambientDimension, int priority)
-    : _ambientDimension(ambientDimension), _priority(priority)
+    : _ambientDimension(ambientDimension), _priority(priority), _callToken(1), _interruptToken(0)
   {
 
   }
@@ -31,6 +31,29 @@ namespace cpm
     violationUpperBound = 0.0;
   }
 
+  bool SeparationOracle::separateRectangles(const double* vector, std::vector<Rectangle>& rectangles, double& violationLowerBound,
+    double& violationUpperBound)
+  {
+    return false;
+  }
+
+  void SeparationOracle::setRectangleStream(const RectangleStream& stream)
+  {
+    _rectangleStream = stream;
+  }
+
+  void SeparationOracle::beginCall()
+  {
+    ++_callToken;
+  }
+
+  void SeparationOracle::interrupt()
+  {
+    // If a new generation starts concurrently, the stored token is outdated and thus ignored.
+
+    _interruptToken = _callToken.load();
+  }
+
   void SeparationOracle::getFeasiblePointProperties(bool& scaledDown, bool& scaledUp, std::vector<std::size_t>& modifiableVariables) const
   {
     scaledDown = false;
@@ -1,9 +1,12 @@
 #ifndef _SEPARATION_ORACLE_H_
 #define _SEPARATION_ORACLE_H_
 
+#include <atomic>
 #include <numeric>
 #include <vector>
 
+#include "rectangle.h"
+
 // TODO: Implement variable names array
 // TODO: Implement variable index mapping from core to oracle (having a subset).
 
@@ -12,9 +15,15 @@ namespace cpm
 
   class SeparationOracle
   {
+  public:
+    typedef std::function<void(const Rectangle&)> RectangleStream;
+
   protected:
     std::size_t _ambientDimension;
     const int _priority;
+    RectangleStream _rectangleStream;
+    std::atomic<std::size_t> _callToken;
+    std::atomic<std::size_t> _interruptToken;
 
   public:
     SeparationOracle(std::size_t ambientDimension, int priority);
@@ -35,6 +44,46 @@ namespace cpm
       std::vector<std::size_t>& begin, std::vector<std::size_t>& indices, std::vector<double>& values, double& violationLowerBound,
       double& violationUpperBound);
 
+    /**
+     * Separates a point by rectangle inequalities. Returns false if the oracle does not produce rectangles, in which case separate()
+     * is used instead.
+     */
+
+    virtual bool separateRectangles(const double* vector, std::vector<Rectangle>& rectangles, double& violationLowerBound,
+      double& violationUpperBound);
+
+    /**
+     * Sets a callback through which separateRectangles() may report rectangles as soon as they are found instead of returning them.
+     * It is called from the thread that called separateRectangles(). An empty callback disables streaming.
+     */
+
+    virtual void setRectangleStream(const RectangleStream& stream);
+
+    /**
+     * Starts a new generation of calls. An interrupt() refers to the generation that was current when it was requested, so it also
+     * reaches a call that has not started yet, but never one of a later generation. A caller that interrupts from another thread must
+     * start a generation before handing out each point.
+     */
+
+    virtual void beginCall();
+
+    /**
+     * Asks a running separateRectangles() or separate() of the current generation to return early since its point is outdated. May
+     * be called from any thread. The results of an interrupted call are valid inequalities, but their violation bounds are
+     * meaningless. Overriding methods must call this one.
+     */
+
+    virtual void interrupt();
+
+    /**
+     * Returns true if an interrupt was requested for the current generation.
+     */
+
+    inline bool interruptRequested() const
+    {
+      return _interruptToken == _callToken;
+    }
+
     virtual void getFeasiblePointProperties(bool& scaledDown, bool& scaledUp, std::vector<std::size_t>& modifiableVariables) const;
 
     virtual std::size_t numFeasiblePoints() const;
@@ -1,8 +1,12 @@
 #include "solver.h"
 
+#include <sstream>
+#include <stdexcept>
+
 namespace cpm {
 
   Solver::Solver()
+    : _verbose(true)
   {
 
   }
@@ -12,12 +16,63 @@ namespace cpm {
 
   }
 
+  std::size_t Solver::addVariables(std::size_t count, const double* objective, const double* lowerBounds, const double* upperBounds,
+    const std::string* names)
+  {
+    std::size_t first = numVariables();
+    for (std::size_t i = 0; i < count; ++i)
+      addVariable(names ? names[i] : std::string(), objective[i], lowerBounds[i], upperBounds[i]);
+    return first;
+  }
+
+  void Solver::changeObjective(std::size_t variable, double objective)
+  {
+    throw std::runtime_error("Solver: Changing objective coefficients is not supported.");
+  }
+
+  void Solver::changeBounds(std::size_t variable, double lowerBound, double upperBound)
+  {
+    throw std::runtime_error("Solver: Changing variable bounds is not supported.");
+  }
+
+  std::string Solver::variableName(std::size_t variable) const
+  {
+    std::map<std::size_t, std::string>::const_iterator iter = _variableNames.find(variable);
+    if (iter != _variableNames.end())
+      return iter->second;
+    if (_nameGenerator)
+      return _nameGenerator(variable);
+
+    std::stringstream ss;
+    ss << "x#" << variable;
+    return ss.str();
+  }
+
   std::size_t Solver::addVariable(const std::string& name)
   {
-    _variableNames.push_back(name);
+    // Only explicitly given names are stored.
+
+    if (!name.empty())
+      _variableNames[_point.size()] = name;
     _point.push_back(0.0);
     _ray.push_back(0.0);
-    return _variableNames.size() - 1;
+    return _point.size() - 1;
+  }
+
+  std::size_t Solver::addVariables(std::size_t count, const std::string* names)
+  {
+    std::size_t first = _point.size();
+    if (names != NULL)
+    {
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        if (!names[i].empty())
+          _variableNames[first + i] = names[i];
+      }
+    }
+    _point.resize(first + count, 0.0);
+    _ray.resize(first + count, 0.0);
+    return first;
   }
 
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <functional>
 
 #include <soplex.h>
 
@@ -23,27 +25,47 @@ namespace cpm
     const static Status UNBOUNDED =  2;
     const static Status INFEASIBLE =  3;
 
+    typedef std::function<std::string(std::size_t)> NameGenerator;
+
     Solver();
 
     virtual ~Solver();
 
     virtual std::size_t addVariable(const std::string& name, double objective, double lowerBound, double upperBound) = 0;
 
+    /**
+     * Adds count variables and returns the index of the first. Names may be NULL, in which case they are generated on demand.
+     */
+
+    virtual std::size_t addVariables(std::size_t count, const double* objective, const double* lowerBounds, const double* upperBounds,
+      const std::string* names = NULL);
+
     virtual void addInequalities(std::vector<double>& lhs, std::vector<double>& rhs, std::vector<std::size_t>& begin,
       std::vector<std::size_t>& indices, std::vector<double>& values) = 0;
 
     virtual Status run() = 0;
 
-    inline const std::string& variableName(std::size_t variable) const
+    std::string variableName(std::size_t variable) const;
+
+    inline void setNameGenerator(const NameGenerator& generator)
     {
-      return _variableNames[variable];
+      _nameGenerator = generator;
     }
 
     virtual double objectiveCoefficient(std::size_t variable) const = 0;
 
+    /**
+     * Change the objective coefficient or the bounds of a variable, keeping all inequalities. Solvers that cannot do this throw
+     * std::runtime_error.
+     */
+
+    virtual void changeObjective(std::size_t variable, double objective);
+
+    virtual void changeBounds(std::size_t variable, double lowerBound, double upperBound);
+
     inline std::size_t numVariables() const
     {
-      return _variableNames.size();
+      return _point.size();
     }
 
     inline const std::vector<double>& point() const
@@ -56,12 +78,31 @@ namespace cpm
       return _ray;
     }
 
+    /**
+     * Reduced costs of all variables, including fixed ones, after the last optimal solve. Empty if the solver does not provide them.
+     */
+
+    inline const std::vector<double>& reducedCosts() const
+    {
+      return _reducedCosts;
+    }
+
+    inline void setVerbose(bool verbose)
+    {
+      _verbose = verbose;
+    }
+
   protected:
     std::size_t addVariable(const std::string& name);
 
-    std::vector<std::string> _variableNames;
+    std::size_t addVariables(std::size_t count, const std::string* names);
+
+    std::map<std::size_t, std::string> _variableNames;
+    NameGenerator _nameGenerator;
     std::vector<double> _point;
     std::vector<double> _ray;
+    std::vector<double> _reducedCosts;
+    bool _verbose;
   };
 
 } /* namespace cpm */
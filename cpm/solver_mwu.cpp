@@ -0,0 +1,220 @@
+#include "solver_mwu.h"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+namespace cpm
+{
+  SolverMultiplicativeWeights::SolverMultiplicativeWeights(double epsilon)
+    : _epsilon(epsilon), _minObjective(std::numeric_limits<double>::infinity()), _numResponses(0), _upperBound(0.0),
+    _restartPending(false)
+  {
+    if (epsilon <= 0.0 || epsilon >= 1.0)
+      throw std::runtime_error("SolverMultiplicativeWeights: epsilon must lie strictly between 0 and 1.");
+  }
+
+  SolverMultiplicativeWeights::~SolverMultiplicativeWeights()
+  {
+
+  }
+
+  std::size_t SolverMultiplicativeWeights::addVariable(const std::string& name, double objective, double lowerBound, double upperBound)
+  {
+    if (lowerBound > 0.0 || upperBound < 0.0)
+      throw std::runtime_error("SolverMultiplicativeWeights: Variable bounds must admit 0.");
+    if (objective > 0.0 && upperBound == std::numeric_limits<double>::infinity())
+      throw std::runtime_error("SolverMultiplicativeWeights: Variables with positive objective must be bounded from above.");
+
+    // Negative lower bounds are clamped to 0 since the packing LP requires x >= 0, so they are not stored.
+
+    _objective.push_back(objective);
+    _upperBounds.push_back(upperBound);
+    _losses.push_back(0.0);
+    _coverage.push_back(0.0);
+    if (objective > 0.0)
+    {
+      _minObjective = std::min(_minObjective, objective);
+      _upperBound += objective * upperBound;
+    }
+
+    return Solver::addVariable(name);
+  }
+
+  double SolverMultiplicativeWeights::objectiveCoefficient(std::size_t variable) const
+  {
+    return _objective[variable];
+  }
+
+  void SolverMultiplicativeWeights::changeObjective(std::size_t variable, double objective)
+  {
+    if (objective > 0.0 && _upperBounds[variable] == std::numeric_limits<double>::infinity())
+      throw std::runtime_error("SolverMultiplicativeWeights: Variables with positive objective must be bounded from above.");
+
+    _objective[variable] = objective;
+    _restartPending = true;
+  }
+
+  void SolverMultiplicativeWeights::changeBounds(std::size_t variable, double lowerBound, double upperBound)
+  {
+    if (lowerBound > 0.0 || upperBound < 0.0)
+      throw std::runtime_error("SolverMultiplicativeWeights: Variable bounds must admit 0.");
+    if (_objective[variable] > 0.0 && upperBound == std::numeric_limits<double>::infinity())
+      throw std::runtime_error("SolverMultiplicativeWeights: Variables with positive objective must be bounded from above.");
+
+    // As in addVariable(), a negative lower bound is clamped to 0.
+
+    _upperBounds[variable] = upperBound;
+    _restartPending = true;
+  }
+
+  void SolverMultiplicativeWeights::restart()
+  {
+    _minObjective = std::numeric_limits<double>::infinity();
+    _upperBound = 0.0;
+    for (std::size_t v = 0; v < numVariables(); ++v)
+    {
+      _losses[v] = 0.0;
+      _coverage[v] = 0.0;
+      if (_objective[v] > 0.0)
+      {
+        _minObjective = std::min(_minObjective, _objective[v]);
+        _upperBound += _objective[v] * _upperBounds[v];
+      }
+    }
+    _numResponses = 0;
+    _restartPending = false;
+  }
+
+  void SolverMultiplicativeWeights::addInequalities(std::vector<double>& lhs, std::vector<double>& rhs, std::vector<std::size_t>& begin,
+    std::vector<std::size_t>& indices, std::vector<double>& values)
+  {
+    assert(lhs.size() == rhs.size());
+    assert(lhs.size() == begin.size() || lhs.size() + 1 == begin.size());
+    assert(indices.size() == values.size());
+    if (_restartPending)
+      restart();
+
+    // Select the row that is most violated by the current point as the best response.
+
+    std::size_t bestRow = lhs.size();
+    double bestActivity = -std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0; i < lhs.size(); ++i)
+    {
+      if (rhs[i] <= 0.0 || lhs[i] > -std::numeric_limits<double>::max())
+        throw std::runtime_error("SolverMultiplicativeWeights: Only packing inequalities with positive right-hand side are supported.");
+
+      std::size_t first = begin[i];
+      std::size_t beyond = (i+1 < lhs.size()) ? begin[i+1] : indices.size();
+      double activity = 0.0;
+      for (std::size_t p = first; p < beyond; ++p)
+        activity += values[p] * _point[indices[p]];
+      activity /= rhs[i];
+      if (activity > bestActivity)
+      {
+        bestActivity = activity;
+        bestRow = i;
+      }
+    }
+    if (bestRow == lhs.size())
+      return;
+
+    // Accumulate coverage and normalized losses, which lie in [0,1] since each coefficient is at most the right-hand side.
+
+    std::size_t first = begin[bestRow];
+    std::size_t beyond = (bestRow+1 < lhs.size()) ? begin[bestRow+1] : indices.size();
+    for (std::size_t p = first; p < beyond; ++p)
+    {
+      std::size_t v = indices[p];
+      if (_objective[v] <= 0.0)
+        continue;
+
+      double ratio = values[p] / rhs[bestRow];
+      assert(ratio >= 0.0 && ratio <= 1.0 + 1.0e-9);
+      _coverage[v] += ratio;
+      _losses[v] += ratio * _minObjective / _objective[v];
+    }
+    ++_numResponses;
+
+    updateUpperBound();
+  }
+
+  void SolverMultiplicativeWeights::updateUpperBound()
+  {
+    // The average response y scaled by lambda together with bound multipliers for the uncovered part yields the dual objective
+    // f(lambda) = lambda + sum_v u_v * max(0, c_v - lambda * coverage_v), which is convex and piecewise linear in lambda.
+
+    std::vector<std::pair<double, double> > breakpoints;
+    double constant = 0.0;
+    double slope = 1.0;
+    for (std::size_t v = 0; v < numVariables(); ++v)
+    {
+      if (_objective[v] <= 0.0)
+        continue;
+
+      double coverage = _coverage[v] / _numResponses;
+      if (coverage <= 0.0)
+        constant += _upperBounds[v] * _objective[v];
+      else
+      {
+        breakpoints.push_back(std::make_pair(_objective[v] / coverage, _upperBounds[v] * coverage));
+        constant += _upperBounds[v] * _objective[v];
+        slope -= _upperBounds[v] * coverage;
+      }
+    }
+    std::sort(breakpoints.begin(), breakpoints.end());
+
+    double lambda = 0.0;
+    double value = constant;
+    double bestValue = value;
+    for (std::size_t i = 0; i < breakpoints.size() && slope < 0.0; ++i)
+    {
+      value += slope * (breakpoints[i].first - lambda);
+      lambda = breakpoints[i].first;
+      slope += breakpoints[i].second;
+      bestValue = std::min(bestValue, value);
+    }
+
+    _upperBound = std::min(_upperBound, bestValue);
+  }
+
+  Solver::Status SolverMultiplicativeWeights::run()
+  {
+    if (_restartPending)
+      restart();
+
+    double minLoss = std::numeric_limits<double>::infinity();
+    for (std::size_t v = 0; v < numVariables(); ++v)
+    {
+      if (_objective[v] > 0.0)
+        minLoss = std::min(minLoss, _losses[v]);
+    }
+
+    double sum = 0.0;
+    for (std::size_t v = 0; v < numVariables(); ++v)
+    {
+      if (_objective[v] > 0.0)
+      {
+        _point[v] = std::exp(-_epsilon * (_losses[v] - minLoss));
+        sum += _point[v];
+      }
+      else
+        _point[v] = 0.0;
+    }
+
+    // Scale such that the objective value equals the upper bound, i.e., oracles find violated rows unless the point is optimal.
+
+    for (std::size_t v = 0; v < numVariables(); ++v)
+    {
+      if (_objective[v] > 0.0)
+        _point[v] *= _upperBound / (sum * _objective[v]);
+    }
+
+    if (_verbose)
+      std::cerr << "SolverMultiplicativeWeights: " << _numResponses << " responses, upper bound = " << _upperBound << std::endl;
+
+    return Solver::OPTIMAL;
+  }
+
+} /* namespace cpm */
@@ -0,0 +1,72 @@
+#ifndef _SOLVER_MWU_H_
+#define _SOLVER_MWU_H_
+
+#include "solver.h"
+
+namespace cpm
+{
+
+  /**
+   * Multiplicative-weights engine for packing LPs max { c^T x : a_i^T x <= b_i } with rows a_i / b_i in [0,1].
+   *
+   * Rows are not stored. Each call to addInequalities() is a best response against the current weights, and run() returns the weight
+   * distribution scaled to the best known upper bound. Lower bounds come from the oracles' scaled feasible points as usual. Variables
+   * with nonpositive objective coefficient are kept at zero.
+   *
+   * Negative lower bounds are clamped to 0, i.e., the engine solves the LP restricted to x >= 0. Its bounds refer to this LP, whose
+   * optimum may be smaller than that of the LP with the original bounds as solved by SoPlex.
+   */
+  class SolverMultiplicativeWeights : public Solver
+  {
+  public:
+    SolverMultiplicativeWeights(double epsilon = 0.1);
+
+    virtual ~SolverMultiplicativeWeights();
+
+    virtual std::size_t addVariable(const std::string& name, double objective, double lowerBound, double upperBound) override;
+
+    virtual double objectiveCoefficient(std::size_t variable) const override;
+
+    /**
+     * Changing the objective or bounds restarts the weights, since earlier responses were chosen against the old problem. The restart
+     * is deferred to the next run() or addInequalities(), so that changing many variables takes linear time in total.
+     */
+
+    virtual void changeObjective(std::size_t variable, double objective) override;
+
+    virtual void changeBounds(std::size_t variable, double lowerBound, double upperBound) override;
+
+    virtual void addInequalities(std::vector<double>& lhs, std::vector<double>& rhs, std::vector<std::size_t>& begin,
+      std::vector<std::size_t>& indices, std::vector<double>& values) override;
+
+    virtual Status run() override;
+
+    inline double upperBound() const
+    {
+      return _upperBound;
+    }
+
+    inline std::size_t numResponses() const
+    {
+      return _numResponses;
+    }
+
+  protected:
+    void updateUpperBound();
+
+    void restart();
+
+    double _epsilon;
+    double _minObjective;
+    std::vector<double> _objective;
+    std::vector<double> _upperBounds;
+    std::vector<double> _losses;
+    std::vector<double> _coverage;
+    std::size_t _numResponses;
+    double _upperBound;
+    bool _restartPending;
+  };
+
+} /* namespace cpm */
+
+#endif /* _SOLVER_MWU_H_ */
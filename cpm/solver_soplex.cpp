@@ -1,5 +1,8 @@
 #include "solver_soplex.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace cpm
 {
   SolverSoPlex::SolverSoPlex()
@@ -23,17 +26,40 @@ namespace cpm
     col.setObj(objective);
     _spx.addColReal(col);
 
-    _point.push_back(0.0);
-    _ray.push_back(0.0);
-
     return Solver::addVariable(name);
   }
 
+  std::size_t SolverSoPlex::addVariables(std::size_t count, const double* objective, const double* lowerBounds,
+    const double* upperBounds, const std::string* names)
+  {
+    assert(_spx.numColsReal() == (int) numVariables());
+
+    // A single call avoids repeated reallocation of SoPlex' column storage.
+
+    soplex::LPColSetReal cols(count, 0);
+    soplex::DSVectorReal empty(0);
+    for (std::size_t i = 0; i < count; ++i)
+      cols.add(objective[i], lowerBounds[i], empty, upperBounds[i]);
+    _spx.addColsReal(cols);
+
+    return Solver::addVariables(count, names);
+  }
+
   double SolverSoPlex::objectiveCoefficient(std::size_t variable) const
   {
     return _spx.objReal(variable);
   }
 
+  void SolverSoPlex::changeObjective(std::size_t variable, double objective)
+  {
+    _spx.changeObjReal(variable, objective);
+  }
+
+  void SolverSoPlex::changeBounds(std::size_t variable, double lowerBound, double upperBound)
+  {
+    _spx.changeBoundsReal(variable, lowerBound, upperBound);
+  }
+
   void SolverSoPlex::addInequalities(std::vector<double>& lhs, std::vector<double>& rhs, std::vector<std::size_t>& begin,
     std::vector<std::size_t>& indices, std::vector<double>& values)
   {
@@ -61,11 +87,55 @@ namespace cpm
   {
     _vector.reDim(numVariables(), false);
 
-    std::cerr << "SolverSoPlex: Solving LP with " << _spx.numRowsReal() << " rows and " << _spx.numColsReal() << " cols..." << std::endl;
+    if (_verbose)
+      std::cerr << "SolverSoPlex: Solving LP with " << _spx.numRowsReal() << " rows and " << _spx.numColsReal() << " cols..." << std::endl;
+
+    return processStatus(_spx.solve());
+  }
 
+  Solver::Status SolverSoPlex::run(const std::atomic<bool>& stop, int sliceIterations, int maxSliceIterations)
+  {
+    _vector.reDim(numVariables(), false);
+
+    // SoPlex continues from the current basis after hitting the iteration limit, which counts the iterations of a single solve.
+
+    int slice = std::max(sliceIterations, 1);
+    int maxSlice = std::max(maxSliceIterations, slice);
+    _spx.setIntParam(soplex::SoPlex::ITERLIMIT, slice);
     soplex::SPxSolver::Status status = _spx.solve();
+    while (status == soplex::SPxSolver::ABORT_ITER && !stop)
+    {
+      slice = slice <= maxSlice / 2 ? 2 * slice : maxSlice;
+      _spx.setIntParam(soplex::SoPlex::ITERLIMIT, slice);
+      status = _spx.solve();
+    }
+    _spx.setIntParam(soplex::SoPlex::ITERLIMIT, -1);
+    if (status == soplex::SPxSolver::ABORT_ITER)
+      return Solver::ITERATION_LIMIT;
 
-    std::cerr << "SolverSoPlex: Status = " << status << ", #iters = " << _spx.numIterations() << ", obj.val = " << _spx.objValueReal() << std::endl;
+    return processStatus(status);
+  }
+
+  void SolverSoPlex::getBasis(std::vector<soplex::SPxSolver::VarStatus>& rowStatus,
+    std::vector<soplex::SPxSolver::VarStatus>& columnStatus) const
+  {
+    rowStatus.resize(_spx.numRowsReal());
+    columnStatus.resize(_spx.numColsReal());
+    _spx.getBasis(rowStatus.data(), columnStatus.data());
+  }
+
+  void SolverSoPlex::setBasis(const std::vector<soplex::SPxSolver::VarStatus>& rowStatus,
+    const std::vector<soplex::SPxSolver::VarStatus>& columnStatus)
+  {
+    assert(rowStatus.size() == (std::size_t) _spx.numRowsReal());
+    assert(columnStatus.size() == (std::size_t) _spx.numColsReal());
+    _spx.setBasis(rowStatus.data(), columnStatus.data());
+  }
+
+  Solver::Status SolverSoPlex::processStatus(soplex::SPxSolver::Status status)
+  {
+    if (_verbose)
+      std::cerr << "SolverSoPlex: Status = " << status << ", #iters = " << _spx.numIterations() << ", obj.val = " << _spx.objValueReal() << std::endl;
     
     if (_spx.hasPrimal())
     {
@@ -80,6 +150,14 @@ namespace cpm
       for (std::size_t v = 0; v < numVariables(); ++v)
         _ray[v] = _vector[v];
     }
+    _reducedCosts.clear();
+    if (_spx.hasDual())
+    {
+      _spx.getRedCostReal(_vector);
+      _reducedCosts.resize(numVariables());
+      for (std::size_t v = 0; v < numVariables(); ++v)
+        _reducedCosts[v] = _vector[v];
+    }
     switch (status)
     {
       case soplex::SPxSolver::NO_RATIOTESTER:
@@ -1,6 +1,8 @@
 #ifndef _SOLVER_SOPLEX_H_
 #define _SOLVER_SOPLEX_H_
 
+#include <atomic>
+
 #include <soplex.h>
 
 #include "solver.h"
@@ -18,14 +20,42 @@ namespace cpm
 
     virtual std::size_t addVariable(const std::string& name, double objective, double lowerBound, double upperBound) override;
 
+    virtual std::size_t addVariables(std::size_t count, const double* objective, const double* lowerBounds, const double* upperBounds,
+      const std::string* names = NULL) override;
+
     virtual double objectiveCoefficient(std::size_t variable) const override;
 
+    virtual void changeObjective(std::size_t variable, double objective) override;
+
+    virtual void changeBounds(std::size_t variable, double lowerBound, double upperBound) override;
+
     virtual void addInequalities(std::vector<double>& lhs, std::vector<double>& rhs, std::vector<std::size_t>& begin,
       std::vector<std::size_t>& indices, std::vector<double>& values) override;
 
     virtual Status run() override;
 
+    /**
+     * Like run(), but solves in slices of simplex iterations and returns ITERATION_LIMIT as soon as stop is set. The first slice has
+     * sliceIterations iterations and every further one twice as many as its predecessor up to maxSliceIterations, so that short solves
+     * restart only a few times while a set stop takes effect within maxSliceIterations iterations. The simplifier should be disabled,
+     * since it drops the basis.
+     */
+
+    Status run(const std::atomic<bool>& stop, int sliceIterations, int maxSliceIterations);
+
+    inline void setIntParam(soplex::SoPlex::IntParam param, int value)
+    {
+      _spx.setIntParam(param, value);
+    }
+
+    void getBasis(std::vector<soplex::SPxSolver::VarStatus>& rowStatus, std::vector<soplex::SPxSolver::VarStatus>& columnStatus) const;
+
+    void setBasis(const std::vector<soplex::SPxSolver::VarStatus>& rowStatus,
+      const std::vector<soplex::SPxSolver::VarStatus>& columnStatus);
+
   protected:
+    Status processStatus(soplex::SPxSolver::Status status);
+
     soplex::SoPlex _spx;
     soplex::DVectorReal _vector;
   };
@@ -0,0 +1,168 @@
+#include "solver_soplex_portfolio.h"
+
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace cpm
+{
+  SolverSoPlexPortfolio::SolverSoPlexPortfolio(std::size_t numInstances, int sliceIterations, int maxSliceIterations)
+    : _sliceIterations(sliceIterations), _maxSliceIterations(maxSliceIterations)
+  {
+    static const int algorithms[] = { soplex::SoPlex::ALGORITHM_DUAL, soplex::SoPlex::ALGORITHM_PRIMAL };
+    static const int pricers[] = { soplex::SoPlex::PRICER_STEEP, soplex::SoPlex::PRICER_DEVEX, soplex::SoPlex::PRICER_QUICKSTEEP };
+
+    // Configurations alternate between dual and primal simplex and cycle through pricers. The simplifier is disabled since it would
+    // discard the basis between the slices of a race.
+
+    if (numInstances == 0)
+      numInstances = 1;
+    for (std::size_t i = 0; i < numInstances; ++i)
+    {
+      SolverSoPlex* instance = new SolverSoPlex();
+      instance->setVerbose(false);
+      instance->setIntParam(soplex::SoPlex::ALGORITHM, algorithms[i % 2]);
+      instance->setIntParam(soplex::SoPlex::PRICER, pricers[(i / 2) % 3]);
+      instance->setIntParam(soplex::SoPlex::SIMPLIFIER, soplex::SoPlex::SIMPLIFIER_OFF);
+      _instances.push_back(instance);
+    }
+    _numWins.resize(numInstances, 0);
+  }
+
+  SolverSoPlexPortfolio::~SolverSoPlexPortfolio()
+  {
+    for (std::size_t i = 0; i < _instances.size(); ++i)
+      delete _instances[i];
+  }
+
+  std::size_t SolverSoPlexPortfolio::addVariable(const std::string& name, double objective, double lowerBound, double upperBound)
+  {
+    for (std::size_t i = 0; i < _instances.size(); ++i)
+      _instances[i]->addVariable(std::string(), objective, lowerBound, upperBound);
+
+    return Solver::addVariable(name);
+  }
+
+  std::size_t SolverSoPlexPortfolio::addVariables(std::size_t count, const double* objective, const double* lowerBounds,
+    const double* upperBounds, const std::string* names)
+  {
+    for (std::size_t i = 0; i < _instances.size(); ++i)
+      _instances[i]->addVariables(count, objective, lowerBounds, upperBounds);
+
+    return Solver::addVariables(count, names);
+  }
+
+  double SolverSoPlexPortfolio::objectiveCoefficient(std::size_t variable) const
+  {
+    return _instances.front()->objectiveCoefficient(variable);
+  }
+
+  void SolverSoPlexPortfolio::changeObjective(std::size_t variable, double objective)
+  {
+    for (std::size_t i = 0; i < _instances.size(); ++i)
+      _instances[i]->changeObjective(variable, objective);
+  }
+
+  void SolverSoPlexPortfolio::changeBounds(std::size_t variable, double lowerBound, double upperBound)
+  {
+    for (std::size_t i = 0; i < _instances.size(); ++i)
+      _instances[i]->changeBounds(variable, lowerBound, upperBound);
+  }
+
+  void SolverSoPlexPortfolio::addInequalities(std::vector<double>& lhs, std::vector<double>& rhs, std::vector<std::size_t>& begin,
+    std::vector<std::size_t>& indices, std::vector<double>& values)
+  {
+    for (std::size_t i = 0; i < _instances.size(); ++i)
+      _instances[i]->addInequalities(lhs, rhs, begin, indices, values);
+  }
+
+  Solver::Status SolverSoPlexPortfolio::run()
+  {
+    if (_verbose)
+    {
+      std::cerr << "SolverSoPlexPortfolio: Racing " << _instances.size() << " instances on LP with " << numVariables() << " cols..."
+        << std::endl;
+    }
+
+    // The first instance that solves the LP to optimality, infeasibility or unboundedness wins and stops the others. Instances that
+    // fail, e.g., due to numerical trouble, let the others continue.
+
+    std::atomic<bool> stop(false);
+    std::mutex winnerMutex;
+    std::size_t winner = _instances.size();
+    Status winnerStatus = Solver::ERROR;
+    std::vector<Status> statuses(_instances.size(), Solver::ITERATION_LIMIT);
+    std::vector<std::exception_ptr> exceptions(_instances.size());
+    auto race = [&](std::size_t i)
+    {
+      try
+      {
+        Status status = _instances[i]->run(stop, _sliceIterations, _maxSliceIterations);
+        statuses[i] = status;
+        if (status != Solver::OPTIMAL && status != Solver::INFEASIBLE && status != Solver::UNBOUNDED)
+          return;
+
+        std::lock_guard<std::mutex> lock(winnerMutex);
+        if (winner == _instances.size())
+        {
+          winner = i;
+          winnerStatus = status;
+          stop = true;
+        }
+      }
+      catch (...)
+      {
+        exceptions[i] = std::current_exception();
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < _instances.size(); ++i)
+      threads.push_back(std::thread(race, i));
+    race(0);
+    for (std::size_t t = 0; t < threads.size(); ++t)
+      threads[t].join();
+
+    if (winner == _instances.size())
+    {
+      for (std::size_t i = 0; i < exceptions.size(); ++i)
+      {
+        if (exceptions[i])
+          std::rethrow_exception(exceptions[i]);
+      }
+      for (std::size_t i = 0; i < statuses.size(); ++i)
+      {
+        if (statuses[i] != Solver::ITERATION_LIMIT)
+        {
+          _point = _instances[i]->point();
+          _ray = _instances[i]->ray();
+          _reducedCosts.clear();
+          return statuses[i];
+        }
+      }
+      return Solver::ERROR;
+    }
+
+    // Warm-start all other instances from the winning basis in the next round.
+
+    SolverSoPlex* instance = _instances[winner];
+    ++_numWins[winner];
+    _point = instance->point();
+    _ray = instance->ray();
+    _reducedCosts = instance->reducedCosts();
+    std::vector<soplex::SPxSolver::VarStatus> rowStatus;
+    std::vector<soplex::SPxSolver::VarStatus> columnStatus;
+    instance->getBasis(rowStatus, columnStatus);
+    for (std::size_t i = 0; i < _instances.size(); ++i)
+    {
+      if (i != winner)
+        _instances[i]->setBasis(rowStatus, columnStatus);
+    }
+
+    if (_verbose)
+      std::cerr << "SolverSoPlexPortfolio: Instance " << winner << " won with status " << winnerStatus << "." << std::endl;
+
+    return winnerStatus;
+  }
+
+} /* namespace cpm */
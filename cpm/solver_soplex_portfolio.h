@@ -0,0 +1,62 @@
+#ifndef _SOLVER_SOPLEX_PORTFOLIO_H_
+#define _SOLVER_SOPLEX_PORTFOLIO_H_
+
+#include "solver_soplex.h"
+
+namespace cpm
+{
+
+  /**
+   * Keeps identical LPs in several SoPlex instances with different simplex algorithms and pricers. Each round they are solved on
+   * separate threads, the first one to reach an optimal, infeasible or unbounded status determines the result, and its basis is
+   * copied to all others. The simplifier of the instances is disabled so that they keep their bases between slices, whose lengths
+   * are capped at maxSliceIterations so that the others stop soon after the winner.
+   */
+
+  class SolverSoPlexPortfolio : public Solver
+  {
+  public:
+    SolverSoPlexPortfolio(std::size_t numInstances = 4, int sliceIterations = 100, int maxSliceIterations = 1000);
+
+    virtual ~SolverSoPlexPortfolio();
+
+    virtual std::size_t addVariable(const std::string& name, double objective, double lowerBound, double upperBound) override;
+
+    virtual std::size_t addVariables(std::size_t count, const double* objective, const double* lowerBounds, const double* upperBounds,
+      const std::string* names = NULL) override;
+
+    virtual double objectiveCoefficient(std::size_t variable) const override;
+
+    virtual void changeObjective(std::size_t variable, double objective) override;
+
+    virtual void changeBounds(std::size_t variable, double lowerBound, double upperBound) override;
+
+    virtual void addInequalities(std::vector<double>& lhs, std::vector<double>& rhs, std::vector<std::size_t>& begin,
+      std::vector<std::size_t>& indices, std::vector<double>& values) override;
+
+    virtual Status run() override;
+
+    inline std::size_t numInstances() const
+    {
+      return _instances.size();
+    }
+
+    /**
+     * Returns how many rounds were won by the given instance.
+     */
+
+    inline std::size_t numWins(std::size_t instance) const
+    {
+      return _numWins[instance];
+    }
+
+  protected:
+    std::vector<SolverSoPlex*> _instances;
+    std::vector<std::size_t> _numWins;
+    int _sliceIterations;
+    int _maxSliceIterations;
+  };
+
+} /* namespace cpm */
+
+#endif /* _SOLVER_SOPLEX_PORTFOLIO_H_ */
@@ -0,0 +1,285 @@
+#include "bound_server.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+BoundServer::BoundServer(const Slackmatrix& slackmatrix, const BoundOptions& options)
+  : _slackmatrix(slackmatrix), _core(NULL)
+{
+  std::size_t maxEntry = 0;
+  for (std::size_t i = 0; i < slackmatrix.nonzeros.size(); ++i)
+    maxEntry = std::max(maxEntry, slackmatrix.nonzeros[i].slack);
+  if (maxEntry == 0)
+    throw std::runtime_error("Matrix is the zero matrix.");
+  if (options.asynchronous && options.solver != "soplex")
+    throw std::runtime_error("Asynchronous mode requires the soplex solver.");
+
+  _core = new cpm::Core(createSolver(options));
+  _core->setGapLimit(options.gapLimit >= 0.0 ? options.gapLimit : (options.solver == "mwu" ? options.epsilon : 0.0));
+  _core->setAdaptiveScheduling(options.adaptiveScheduling);
+  _core->setAsynchronous(options.asynchronous, options.asyncMinCuts);
+  _core->setVerbose(options.verbose);
+
+  // Variables
+
+  std::size_t numNonzeros = slackmatrix.nonzeros.size();
+  _weights.resize(numNonzeros);
+  for (std::size_t i = 0; i < numNonzeros; ++i)
+    _weights[i] = double(slackmatrix.nonzeros[i].slack) / maxEntry;
+  _objective = _weights;
+  _active.assign(numNonzeros, true);
+  _activeRows.assign(slackmatrix.numRows, true);
+  _activeColumns.assign(slackmatrix.numColumns, true);
+  std::vector<double> lowerBounds(numNonzeros, -std::numeric_limits<double>::infinity());
+  std::vector<double> upperBounds(numNonzeros, 1.0);
+  _core->addVariables(numNonzeros, _objective.data(), lowerBounds.data(), upperBounds.data());
+  _core->setNameGenerator([&slackmatrix](std::size_t i)
+    {
+      std::stringstream ss;
+      ss << "nonzero#" << i << "#" << slackmatrix.nonzeros[i].row << "#" << slackmatrix.nonzeros[i].column;
+      return ss.str();
+    });
+  _core->setRectangleExpander([&slackmatrix](const cpm::Rectangle& rectangle, std::vector<std::size_t>& indices)
+    {
+      slackmatrix.expandRectangle(rectangle, indices);
+    });
+
+  // Oracles
+
+  try
+  {
+    for (std::size_t o = 0; o < options.oracles.size(); ++o)
+    {
+      const std::string& name = options.oracles[o];
+      _oracles.push_back(createOracle(name, slackmatrix, options));
+      std::map<std::string, double>::const_iterator budget = options.oracleTimeBudgets.find(name);
+      _core->addOracle(_oracles.back(),
+        budget != options.oracleTimeBudgets.end() ? budget->second : std::numeric_limits<double>::infinity());
+    }
+  }
+  catch (...)
+  {
+    delete _core;
+    for (std::size_t o = 0; o < _oracles.size(); ++o)
+      delete _oracles[o];
+    throw;
+  }
+}
+
+BoundServer::~BoundServer()
+{
+  delete _core;
+  for (std::size_t o = 0; o < _oracles.size(); ++o)
+    delete _oracles[o];
+}
+
+void BoundServer::updateVariables()
+{
+  // Entries outside the selected rows and columns are fixed to 0. Restricting every rectangle to the selection yields a rectangle of
+  // the submatrix, so all existing cuts remain valid.
+
+  for (std::size_t i = 0; i < _slackmatrix.nonzeros.size(); ++i)
+  {
+    bool active = _activeRows[_slackmatrix.nonzeros[i].row] && _activeColumns[_slackmatrix.nonzeros[i].column];
+    double objective = active ? _weights[i] : 0.0;
+    if (active != _active[i])
+    {
+      if (active)
+      {
+        _core->changeBounds(i, -std::numeric_limits<double>::infinity(), 1.0);
+        _core->changeObjective(i, objective);
+      }
+      else
+      {
+        _core->changeObjective(i, objective);
+        _core->changeBounds(i, 0.0, 0.0);
+      }
+      _active[i] = active;
+      _objective[i] = objective;
+    }
+    else if (objective != _objective[i])
+    {
+      _core->changeObjective(i, objective);
+      _objective[i] = objective;
+    }
+  }
+}
+
+std::string BoundServer::handleRequest(const std::string& request, bool& quit)
+{
+  std::stringstream input(request);
+  std::string command;
+  input >> command;
+  quit = false;
+  try
+  {
+    if (command == "weights")
+    {
+      std::vector<double> weights;
+      double weight;
+      while (input >> weight)
+        weights.push_back(weight);
+      if (weights.size() != _weights.size())
+        return "error expected one weight per nonzero";
+
+      // Active nonzeros are unbounded below, so a negative weight would make the LP unbounded.
+
+      for (std::size_t i = 0; i < weights.size(); ++i)
+      {
+        if (weights[i] < 0.0)
+          return "error weights must be nonnegative";
+      }
+      _weights = weights;
+      updateVariables();
+    }
+    else if (command == "slacks")
+    {
+      std::size_t maxEntry = 0;
+      for (std::size_t i = 0; i < _slackmatrix.nonzeros.size(); ++i)
+        maxEntry = std::max(maxEntry, _slackmatrix.nonzeros[i].slack);
+      for (std::size_t i = 0; i < _weights.size(); ++i)
+        _weights[i] = double(_slackmatrix.nonzeros[i].slack) / maxEntry;
+      updateVariables();
+    }
+    else if (command == "rows" || command == "columns")
+    {
+      std::vector<bool>& selection = command == "rows" ? _activeRows : _activeColumns;
+      std::vector<bool> newSelection(selection.size(), false);
+      std::string token;
+      while (input >> token)
+      {
+        if (token == "all")
+        {
+          newSelection.assign(selection.size(), true);
+          continue;
+        }
+        char* end = NULL;
+        unsigned long index = strtoul(token.c_str(), &end, 10);
+        if (*end != '\0' || index >= newSelection.size())
+          return "error invalid index <" + token + ">";
+        newSelection[index] = true;
+      }
+      selection = newSelection;
+      updateVariables();
+    }
+    else if (command == "gap")
+    {
+      double gap;
+      if (!(input >> gap) || gap < 0.0)
+        return "error invalid gap";
+      _core->setGapLimit(gap);
+    }
+    else if (command == "solve")
+    {
+      std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+      _core->run();
+      double time = std::chrono::duration_cast<std::chrono::duration<double> >(std::chrono::steady_clock::now() - timeStart).count();
+      std::stringstream answer;
+      answer << "ok primal " << std::max(_core->primalBound(), 0.0) << " dual " << _core->dualBound() << " rounds "
+        << _core->numRounds() << " cuts " << _core->numInequalities() << " time " << time;
+      return answer.str();
+    }
+    else if (command == "quit")
+      quit = true;
+    else
+      return "error unknown request <" + command + ">";
+  }
+  catch (std::exception& e)
+  {
+    return std::string("error ") + e.what();
+  }
+  return "ok";
+}
+
+void BoundServer::serve(std::istream& input, std::ostream& output)
+{
+  std::string line;
+  bool quit = false;
+  while (!quit && std::getline(input, line))
+  {
+    if (line.empty())
+      continue;
+    output << handleRequest(line, quit) << std::endl;
+  }
+}
+
+void BoundServer::serveSocket(const std::string& path)
+{
+  int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listener < 0)
+    throw std::runtime_error(std::string("BoundServer: Cannot create socket: ") + strerror(errno));
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path))
+  {
+    close(listener);
+    throw std::runtime_error("BoundServer: Socket path <" + path + "> is too long.");
+  }
+  strcpy(address.sun_path, path.c_str());
+  unlink(path.c_str());
+  if (bind(listener, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 1) != 0)
+  {
+    close(listener);
+    throw std::runtime_error("BoundServer: Cannot listen on <" + path + ">: " + strerror(errno));
+  }
+
+  // Clients are served one at a time, and each sends newline-terminated requests.
+
+  bool quit = false;
+  while (!quit)
+  {
+    int connection = accept(listener, NULL, NULL);
+    if (connection < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+
+    std::string buffer;
+    char chunk[4096];
+    while (!quit)
+    {
+      ssize_t received = read(connection, chunk, sizeof(chunk));
+      if (received < 0 && errno == EINTR)
+        continue;
+      if (received <= 0)
+        break;
+      buffer.append(chunk, received);
+      std::size_t newline;
+      while (!quit && (newline = buffer.find('\n')) != std::string::npos)
+      {
+        std::string line = buffer.substr(0, newline);
+        buffer.erase(0, newline + 1);
+        if (line.empty())
+          continue;
+        std::string answer = handleRequest(line, quit) + "\n";
+        const char* bytes = answer.data();
+        std::size_t size = answer.size();
+        while (size > 0)
+        {
+          ssize_t written = send(connection, bytes, size, MSG_NOSIGNAL);
+          if (written < 0 && errno == EINTR)
+            continue;
+          if (written <= 0)
+            break;
+          bytes += written;
+          size -= written;
+        }
+      }
+    }
+    close(connection);
+  }
+  close(listener);
+  unlink(path.c_str());
+}
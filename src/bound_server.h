@@ -0,0 +1,66 @@
+#ifndef _BOUND_SERVER_H_
+#define _BOUND_SERVER_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cpm/core.h>
+
+#include "bounds.h"
+#include "slackmatrix.h"
+
+/**
+ * Keeps the LP, its cuts and the oracles of one matrix resident to answer a sequence of queries with changed weights, restricted
+ * rows and columns or changed tolerances. Every query starts from the cuts and the basis of the previous one.
+ *
+ * Requests are lines of the form
+ *   weights W_1 ... W_n     nonnegative objective coefficients per nonzero
+ *   slacks                  objective coefficients given by the scaled slacks (default)
+ *   rows all | R_1 ... R_k  restrict to the given rows
+ *   columns all | C_1 ...   restrict to the given columns
+ *   gap GAP                 relative gap limit
+ *   solve                   compute bounds
+ *   quit                    end the session
+ * Each request is answered by one line starting with "ok" or "error".
+ */
+
+class BoundServer
+{
+public:
+  BoundServer(const Slackmatrix& slackmatrix, const BoundOptions& options);
+
+  ~BoundServer();
+
+  /**
+   * Handles a request and returns the answer. Sets quit if the session shall end.
+   */
+
+  std::string handleRequest(const std::string& request, bool& quit);
+
+  /**
+   * Serves requests read line-wise from input until it ends or quit is requested.
+   */
+
+  void serve(std::istream& input, std::ostream& output);
+
+  /**
+   * Listens on a Unix socket at the given path and serves one connection after another until a client requests quit.
+   */
+
+  void serveSocket(const std::string& path);
+
+protected:
+  void updateVariables();
+
+  const Slackmatrix& _slackmatrix;
+  cpm::Core* _core;
+  std::vector<cpm::SeparationOracle*> _oracles;
+  std::vector<double> _weights;
+  std::vector<bool> _activeRows;
+  std::vector<bool> _activeColumns;
+  std::vector<double> _objective;
+  std::vector<bool> _active;
+};
+
+#endif /* _BOUND_SERVER_H_ */
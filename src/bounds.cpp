@@ -0,0 +1,692 @@
+#include "bounds.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <cpm/solver_soplex.h>
+#include <cpm/solver_soplex_portfolio.h>
+#include <cpm/solver_mwu.h>
+
+#include "coarsening.h"
+#include "decomposition.h"
+#include "enum_oracle.h"
+#include "fooling_set.h"
+#include "process_oracle.h"
+#include "rectangle_library.h"
+#include "reordering.h"
+#include "subset_oracle.h"
+#include "scip_oracle.h"
+#include "separation_trace.h"
+
+BoundOptions::BoundOptions()
+  : solver("soplex"), epsilon(0.1), gapLimit(-1.0), adaptiveScheduling(true), cutLimit(0), escalate(false), restrictSupport(false),
+  oracleProcesses(0), asynchronous(false), asyncMinCuts(1), foolingSet(true), subsetSize(3), subsetExactLimit(24), oracleThreads(1),
+  decompose(false), multilevel(0), multilevelSimilarity(0.8), activationBatch(1000), activationRows(1000),
+  reorder("none"), numThreads(std::max(1u, std::thread::hardware_concurrency())), storeCuts(false), verbose(false)
+{
+  oracles.push_back("enum");
+  oracles.push_back("exact");
+}
+
+BoundResult::BoundResult()
+  : primalBound(0.0), dualBound(std::numeric_limits<double>::infinity()), unproven(false)
+{
+  statistics.time = 0.0;
+  statistics.numComponents = 1;
+  statistics.numRounds = 0;
+}
+
+static void checkOptions(const BoundOptions& options)
+{
+  if (options.solver != "soplex" && options.solver != "portfolio" && options.solver != "mwu")
+    throw std::runtime_error("Unknown solver <" + options.solver + ">.");
+  for (std::size_t o = 0; o < options.oracles.size(); ++o)
+  {
+    const std::string& name = options.oracles[o];
+    if (name != "enum" && name != "subset" && name != "heuristic" && name != "exact")
+      throw std::runtime_error("Unknown oracle <" + name + ">.");
+  }
+  if (options.multilevel > 0 && !(options.multilevelSimilarity > 0.0 && options.multilevelSimilarity <= 1.0))
+    throw std::runtime_error("Multilevel similarity must lie in (0,1].");
+  if (!options.activation.empty() && options.activation != "heaviest" && options.activation != "diagonal"
+    && options.activation != "fooling-set")
+  {
+    throw std::runtime_error("Unknown activation <" + options.activation + ">.");
+  }
+  if (!options.activation.empty() && options.asynchronous)
+    throw std::runtime_error("Progressive activation is not available in asynchronous mode.");
+
+  // Asynchronous mode needs an exact optimum of every LP, which neither the multiplicative weights method nor a portfolio race
+  // without winner provides.
+
+  if (options.asynchronous && options.solver != "soplex")
+    throw std::runtime_error("Asynchronous mode requires the soplex solver.");
+  if (options.reorder != "none" && options.reorder != "rcm" && options.reorder != "weight")
+    throw std::runtime_error("Unknown ordering <" + options.reorder + ">.");
+}
+
+cpm::Solver* createSolver(const BoundOptions& options)
+{
+  if (options.solver == "mwu")
+    return new cpm::SolverMultiplicativeWeights(options.epsilon);
+  else if (options.solver == "portfolio")
+    return new cpm::SolverSoPlexPortfolio(std::min<std::size_t>(options.numThreads, 4));
+  else if (options.solver == "soplex")
+    return new cpm::SolverSoPlex();
+  else
+    throw std::runtime_error("Unknown solver <" + options.solver + ">.");
+}
+
+/* Applies the options that concern a single SCIP oracle. */
+
+static void configureScipOracle(MaximumWeightRectangleIPOracle& scipOracle, const BoundOptions& options)
+{
+  scipOracle.setViolatedSolutionLimit(options.cutLimit);
+  scipOracle.setSupportRestriction(options.restrictSupport);
+  if (options.escalate)
+  {
+    scipOracle.addEscalationStage(1, 0.5, 10.0);
+    scipOracle.addEscalationStage(1000, 0.1, 60.0);
+    scipOracle.addEscalationStage(100000, 0.01, 600.0);
+  }
+}
+
+/* Creates the oracle of the given name. SCIP oracles use the given model, which is created if it does not exist yet, except for the
+ * exact oracle on several threads, whose threads have models of their own. */
+
+static cpm::SeparationOracle* createOracle(const std::string& name, const Slackmatrix& slackmatrix, const BoundOptions& options,
+  std::shared_ptr<MaximumWeightRectangleIPModel>& scipModel)
+{
+  if (options.oracleProcesses > 0 && (name == "heuristic" || name == "exact"))
+  {
+    return new ProcessPoolOracle(slackmatrix, name == "heuristic" ? 1 : -1, name, options, options.oracleProcesses,
+      options.workerExecutable.empty() ? ProcessPoolOracle::defaultWorkerExecutable() : options.workerExecutable);
+  }
+
+  MaximumWeightRectangleIPOracle* scipOracle = NULL;
+  if (name == "enum")
+    return new MaximumWeightRectangleEnumOracle(slackmatrix, 2);
+  else if (name == "subset")
+  {
+    MaximumWeightRectangleSubsetOracle* subsetOracle = new MaximumWeightRectangleSubsetOracle(slackmatrix, 1, options.subsetSize,
+      options.subsetExactLimit);
+    subsetOracle->setNumThreads(options.oracleThreads);
+    return subsetOracle;
+  }
+  else if (name != "heuristic" && name != "exact")
+    throw std::runtime_error("Unknown oracle <" + name + ">.");
+  else if (name == "exact" && options.oracleThreads > 1)
+  {
+    MaximumWeightRectangleParallelIPOracle* parallelOracle = new MaximumWeightRectangleParallelIPOracle(slackmatrix, -1,
+      options.oracleThreads);
+    for (std::size_t t = 0; t < parallelOracle->numOracles(); ++t)
+      configureScipOracle(parallelOracle->oracle(t), options);
+    return parallelOracle;
+  }
+
+  if (!scipModel)
+    scipModel.reset(new MaximumWeightRectangleIPModel(slackmatrix));
+  if (name == "heuristic")
+  {
+    scipOracle = new MaximumWeightRectangleIPOracle(scipModel, 1);
+    scipOracle->setIntParam("limits/bestsol", 2);
+  }
+  else
+    scipOracle = new MaximumWeightRectangleIPOracle(scipModel, -1);
+
+  configureScipOracle(*scipOracle, options);
+  return scipOracle;
+}
+
+cpm::SeparationOracle* createOracle(const std::string& name, const Slackmatrix& slackmatrix, const BoundOptions& options)
+{
+  std::shared_ptr<MaximumWeightRectangleIPModel> scipModel;
+  return createOracle(name, slackmatrix, options, scipModel);
+}
+
+/* Selects the nonzeros that are active initially in progressive activation mode. */
+
+static void selectInitialEntries(const Slackmatrix& slackmatrix, const BoundOptions& options, ThreadBudget* threadBudget,
+  std::vector<std::size_t>& entries)
+{
+  entries.clear();
+  if (options.activation == "heaviest")
+  {
+    std::vector<std::size_t> order(slackmatrix.nonzeros.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+      order[i] = i;
+    std::size_t count = std::min(options.activationBatch, order.size());
+    std::partial_sort(order.begin(), order.begin() + count, order.end(), [&slackmatrix](std::size_t a, std::size_t b)
+      {
+        return slackmatrix.nonzeros[a].slack > slackmatrix.nonzeros[b].slack;
+      });
+    entries.assign(order.begin(), order.begin() + count);
+  }
+  else if (options.activation == "diagonal")
+  {
+    const std::size_t none = std::numeric_limits<std::size_t>::max();
+    std::vector<std::size_t> heaviestInRow(slackmatrix.numRows, none);
+    std::vector<std::size_t> heaviestInColumn(slackmatrix.numColumns, none);
+    for (std::size_t i = 0; i < slackmatrix.nonzeros.size(); ++i)
+    {
+      const Slackmatrix::Nonzero& nonzero = slackmatrix.nonzeros[i];
+      if (heaviestInRow[nonzero.row] == none || nonzero.slack > slackmatrix.nonzeros[heaviestInRow[nonzero.row]].slack)
+        heaviestInRow[nonzero.row] = i;
+      if (heaviestInColumn[nonzero.column] == none || nonzero.slack > slackmatrix.nonzeros[heaviestInColumn[nonzero.column]].slack)
+        heaviestInColumn[nonzero.column] = i;
+    }
+    std::vector<bool> selected(slackmatrix.nonzeros.size(), false);
+    for (std::size_t row = 0; row < slackmatrix.numRows; ++row)
+    {
+      if (heaviestInRow[row] != none)
+        selected[heaviestInRow[row]] = true;
+    }
+    for (std::size_t column = 0; column < slackmatrix.numColumns; ++column)
+    {
+      if (heaviestInColumn[column] != none)
+        selected[heaviestInColumn[column]] = true;
+    }
+    for (std::size_t i = 0; i < selected.size(); ++i)
+    {
+      if (selected[i])
+        entries.push_back(i);
+    }
+  }
+  else
+  {
+    FoolingSetHeuristic foolingSet(slackmatrix, options.numThreads, threadBudget);
+    foolingSet.run();
+    entries = foolingSet.foolingSet();
+    std::sort(entries.begin(), entries.end());
+  }
+}
+
+/* Solves the LP of a matrix. If rectangles is not NULL, all rectangles of the final LP are stored there. With a thread budget, threads
+ * beyond the calling one are taken from it. */
+
+static void solveMatrix(std::size_t component, const Slackmatrix& slackmatrix, double scalingFactor, const BoundOptions& options,
+  RectangleLibrary* library, ThreadBudget* threadBudget, BoundResult& result, std::vector<cpm::Rectangle>* rectangles = NULL)
+{
+  // In multilevel mode, the LP of a coarsened matrix is solved first, unless coarsening hardly shrinks the matrix.
+
+  std::vector<cpm::Rectangle> projectedRectangles;
+  std::unique_ptr<FixedPointHeuristic> projectedPoint;
+  if (options.multilevel > 0)
+  {
+    SlackmatrixCoarsening coarsening(slackmatrix, options.multilevelSimilarity);
+    const Slackmatrix& coarse = coarsening.coarse();
+    if (!coarse.nonzeros.empty() && 10 * (coarse.numRows + coarse.numColumns) < 9 * (slackmatrix.numRows + slackmatrix.numColumns))
+    {
+      if (options.verbose)
+      {
+        std::cerr << "Coarsened " << slackmatrix.numRows << "x" << slackmatrix.numColumns << " matrix to " << coarse.numRows << "x"
+          << coarse.numColumns << "." << std::endl;
+      }
+      BoundOptions coarseOptions = options;
+      --coarseOptions.multilevel;
+      coarseOptions.storeCuts = false;
+      coarseOptions.traceFile.clear();
+      coarseOptions.progressCallback = BoundProgressCallback();
+      BoundResult coarseResult;
+      std::vector<cpm::Rectangle> coarseRectangles;
+      solveMatrix(component, coarse, scalingFactor, coarseOptions, NULL, threadBudget, coarseResult, &coarseRectangles);
+
+      projectedRectangles.resize(coarseRectangles.size());
+      for (std::size_t i = 0; i < coarseRectangles.size(); ++i)
+        coarsening.projectRectangle(coarseRectangles[i], projectedRectangles[i]);
+      std::vector<double> point;
+      coarsening.projectPoint(coarseResult.point, point);
+      projectedPoint.reset(new FixedPointHeuristic(point));
+    }
+  }
+
+  // With a thread budget, the portfolio solver only races as many configurations as it obtains threads.
+
+  bool portfolio = options.solver == "portfolio";
+  std::size_t numInstances = std::max<std::size_t>(std::min<std::size_t>(options.numThreads, 4), 1);
+  ThreadReservation solverThreads(portfolio ? threadBudget : NULL, portfolio ? numInstances - 1 : 0);
+  cpm::Core core(portfolio ? new cpm::SolverSoPlexPortfolio(solverThreads.numThreads()) : createSolver(options));
+  core.setGapLimit(options.gapLimit >= 0.0 ? options.gapLimit : (options.solver == "mwu" ? options.epsilon : 0.0));
+  core.setAdaptiveScheduling(options.adaptiveScheduling);
+  core.setAsynchronous(options.asynchronous, options.asyncMinCuts);
+  core.setVerbose(options.verbose);
+  core.setStoreInequalities(options.storeCuts || library != NULL || rectangles != NULL);
+
+  // New rectangles are appended to the library after every round, so that an interrupted run keeps what it found. The first
+  // numSeeded rectangles came from the library.
+
+  std::size_t numSeeded = 0;
+  std::size_t numStoredRectangles = 0;
+  std::size_t numStoredInequalities = 0;
+  auto storeInLibrary = [&core, &slackmatrix, library, &numSeeded, &numStoredRectangles, &numStoredInequalities]()
+  {
+    for (; numStoredInequalities < core.inequalities().size(); ++numStoredInequalities)
+      library->append(slackmatrix, core.inequalities()[numStoredInequalities].indices);
+    for (numStoredRectangles = std::max(numStoredRectangles, numSeeded); numStoredRectangles < core.rectangles().size();
+      ++numStoredRectangles)
+    {
+      library->append(slackmatrix, core.rectangles()[numStoredRectangles]);
+    }
+  };
+  if (options.progressCallback || library != NULL)
+  {
+    const BoundProgressCallback& callback = options.progressCallback;
+    core.setProgressCallback([component, &callback, library, &storeInLibrary](const cpm::Core::Progress& coreProgress)
+      {
+        if (library != NULL)
+          storeInLibrary();
+        if (callback)
+        {
+          BoundProgress progress = { component, coreProgress.time, coreProgress.round, coreProgress.primalBound,
+            coreProgress.dualBound, coreProgress.numInequalities };
+          callback(progress);
+        }
+      });
+  }
+
+  // Variables
+
+  std::vector<double> objective(slackmatrix.nonzeros.size());
+  for (std::size_t i = 0; i < slackmatrix.nonzeros.size(); ++i)
+    objective[i] = scalingFactor * slackmatrix.nonzeros[i].slack;
+  std::vector<double> lowerBounds(slackmatrix.nonzeros.size(), -std::numeric_limits<double>::infinity());
+  std::vector<double> upperBounds(slackmatrix.nonzeros.size(), 1.0);
+  core.addVariables(objective.size(), objective.data(), lowerBounds.data(), upperBounds.data());
+  if (!options.activation.empty())
+  {
+    std::vector<std::size_t> initialEntries;
+    selectInitialEntries(slackmatrix, options, threadBudget, initialEntries);
+    core.setActiveVariables(initialEntries, options.activationBatch);
+    if (options.verbose)
+    {
+      std::cerr << "Starting with " << initialEntries.size() << " of " << slackmatrix.nonzeros.size() << " nonzeros active."
+        << std::endl;
+    }
+  }
+  core.setNameGenerator([&slackmatrix](std::size_t i)
+    {
+      std::stringstream ss;
+      ss << "nonzero#" << i << "#" << slackmatrix.nonzeros[i].row << "#" << slackmatrix.nonzeros[i].column;
+      return ss.str();
+    });
+
+  // Oracles emit rectangles, which are expanded to nonzeros only when they are added to the LP.
+
+  core.setRectangleExpander([&slackmatrix](const cpm::Rectangle& rectangle, std::vector<std::size_t>& indices)
+    {
+      slackmatrix.expandRectangle(rectangle, indices);
+    });
+
+  // With a trace file, every oracle is wrapped to record the points it separates.
+
+  std::unique_ptr<SeparationTraceWriter> traceWriter;
+  if (!options.traceFile.empty())
+  {
+    std::stringstream traceFile;
+    traceFile << options.traceFile;
+    if (component > 0)
+      traceFile << "." << component;
+    traceWriter.reset(new SeparationTraceWriter(traceFile.str(), slackmatrix));
+  }
+
+  // The SCIP oracles share one model, which is only built once one of them is called. In asynchronous mode they run concurrently and
+  // hence get models of their own.
+
+  std::vector<std::unique_ptr<cpm::SeparationOracle> > oracles;
+  std::shared_ptr<MaximumWeightRectangleIPModel> scipModel;
+  for (std::size_t o = 0; o < options.oracles.size(); ++o)
+  {
+    const std::string& name = options.oracles[o];
+    if (options.asynchronous)
+      scipModel.reset();
+    cpm::SeparationOracle* oracle = createOracle(name, slackmatrix, options, scipModel);
+    oracles.push_back(std::unique_ptr<cpm::SeparationOracle>(oracle));
+    if (traceWriter)
+    {
+      oracle = new RecordingOracle(oracle, traceWriter.get());
+      oracles.push_back(std::unique_ptr<cpm::SeparationOracle>(oracle));
+    }
+    std::map<std::string, double>::const_iterator budget = options.oracleTimeBudgets.find(name);
+    core.addOracle(oracle, budget != options.oracleTimeBudgets.end() ? budget->second : std::numeric_limits<double>::infinity());
+  }
+
+  // Heuristics
+
+  std::unique_ptr<FoolingSetHeuristic> foolingSet;
+  if (options.foolingSet)
+  {
+    foolingSet.reset(new FoolingSetHeuristic(slackmatrix, options.numThreads, threadBudget));
+    core.addHeuristic(foolingSet.get());
+  }
+  if (projectedPoint)
+    core.addHeuristic(projectedPoint.get());
+
+  // Seed the LP with the stored rectangles that are still valid.
+
+  if (library != NULL)
+  {
+    std::vector<cpm::Rectangle> rectangles;
+    library->findValid(slackmatrix, rectangles);
+    core.addRectangles(rectangles);
+    numSeeded = core.rectangles().size();
+    if (options.verbose)
+      std::cerr << "Seeded LP with " << numSeeded << " of " << library->numRectangles() << " stored rectangles." << std::endl;
+  }
+  if (!projectedRectangles.empty())
+  {
+    std::size_t numProjected = core.addRectangles(projectedRectangles);
+    if (options.verbose)
+      std::cerr << "Seeded LP with " << numProjected << " rectangles projected from the coarse matrix." << std::endl;
+  }
+
+  // Run
+
+  core.run();
+
+  result.primalBound = std::max(core.primalBound(), 0.0);
+  result.dualBound = core.dualBound();
+  result.unproven = core.unproven();
+  if (core.bestSolution())
+    result.point = core.bestSolution()->values;
+  else
+    result.point.assign(slackmatrix.nonzeros.size(), 0.0);
+  result.cuts.clear();
+  if (options.storeCuts)
+  {
+    for (std::size_t i = 0; i < core.inequalities().size(); ++i)
+      result.cuts.push_back(core.inequalities()[i].indices);
+    for (std::size_t i = 0; i < core.rectangles().size(); ++i)
+    {
+      result.cuts.push_back(std::vector<std::size_t>());
+      slackmatrix.expandRectangle(core.rectangles()[i], result.cuts.back());
+    }
+  }
+  if (library != NULL)
+    storeInLibrary();
+  if (rectangles != NULL)
+    *rectangles = core.rectangles();
+  result.statistics.numRounds = core.numRounds();
+  result.statistics.oracles.clear();
+  for (std::size_t o = 0; o < core.numOracles(); ++o)
+    result.statistics.oracles.push_back(core.oracleStatistics(o));
+}
+
+BoundResult computeBound(const Slackmatrix& slackmatrix, const BoundOptions& options)
+{
+  checkOptions(options);
+  std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+
+  std::size_t maxEntry = 0;
+  for (std::size_t i = 0; i < slackmatrix.nonzeros.size(); ++i)
+    maxEntry = std::max(maxEntry, slackmatrix.nonzeros[i].slack);
+  if (maxEntry == 0)
+    throw std::runtime_error("Matrix is the zero matrix.");
+  double scalingFactor = 1.0 / maxEntry;
+
+  // Solve the reordered matrix and map points and cuts back to the original nonzeros.
+
+  if (options.reorder != "none")
+  {
+    std::vector<std::size_t> rowOrder;
+    std::vector<std::size_t> columnOrder;
+    std::vector<std::size_t> nonzeroOrder;
+    computeOrdering(slackmatrix, options.reorder, rowOrder, columnOrder);
+    BoundOptions permutedOptions = options;
+    permutedOptions.reorder = "none";
+    BoundResult result = computeBound(permuteSlackmatrix(slackmatrix, rowOrder, columnOrder, nonzeroOrder), permutedOptions);
+
+    std::vector<double> point(result.point.size());
+    for (std::size_t i = 0; i < nonzeroOrder.size(); ++i)
+      point[nonzeroOrder[i]] = result.point[i];
+    result.point.swap(point);
+    for (std::size_t c = 0; c < result.cuts.size(); ++c)
+    {
+      for (std::size_t i = 0; i < result.cuts[c].size(); ++i)
+        result.cuts[c][i] = nonzeroOrder[result.cuts[c][i]];
+      std::sort(result.cuts[c].begin(), result.cuts[c].end());
+    }
+    result.statistics.time = std::chrono::duration_cast<std::chrono::duration<double> >(std::chrono::steady_clock::now() - timeStart).count();
+    return result;
+  }
+
+  std::unique_ptr<RectangleLibrary> library;
+  if (!options.rectangleLibrary.empty())
+    library.reset(new RectangleLibrary(options.rectangleLibrary));
+
+  BoundResult result;
+  std::vector<SlackmatrixComponent> components;
+  if (options.decompose)
+    findComponents(slackmatrix, components);
+  if (components.size() > 1)
+  {
+    solveComponents(slackmatrix, components, scalingFactor,
+      [&options, &library, scalingFactor](std::size_t index, const Slackmatrix& component, ThreadBudget* threadBudget,
+        BoundResult& componentResult)
+      {
+        solveMatrix(index, component, scalingFactor, options, library.get(), threadBudget, componentResult);
+      }, options.numThreads, result);
+  }
+  else
+    solveMatrix(0, slackmatrix, scalingFactor, options, library.get(), NULL, result);
+
+  result.statistics.time = std::chrono::duration_cast<std::chrono::duration<double> >(std::chrono::steady_clock::now() - timeStart).count();
+  return result;
+}
+
+BoundResult computeBound(std::size_t numRows, std::size_t numColumns, const std::vector<Slackmatrix::Nonzero>& nonzeros,
+  const BoundOptions& options)
+{
+  return computeBound(Slackmatrix(numRows, numColumns, nonzeros), options);
+}
+
+BoundResult computeBound(ImplicitSlackmatrix& matrix, const BoundOptions& options, std::vector<std::size_t>& rows)
+{
+  checkOptions(options);
+  if (options.reorder != "none" || options.decompose || options.multilevel > 0 || !options.traceFile.empty())
+    throw std::runtime_error("Progressive row activation does not support reordering, decomposition, multilevel mode or traces.");
+  std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+
+  // The LP of a single row has the value of its heaviest entry, and the LP of a matrix is at most the sum of the LPs of a partition of
+  // its rows. Hence the dual bound for a subset of the rows plus the heaviest entries of the remaining rows is a valid dual bound, while
+  // the primal bound for a subset is valid as it is. Rows are activated by decreasing heaviest entry, which shrinks that sum fastest.
+
+  std::vector<std::size_t> rowMaxima;
+  matrix.rowMaxima(rowMaxima, options.numThreads);
+  std::vector<std::size_t> order;
+  std::size_t maxEntry = 0;
+  for (std::size_t row = 0; row < matrix.numRows(); ++row)
+  {
+    if (rowMaxima[row] > 0)
+      order.push_back(row);
+    maxEntry = std::max(maxEntry, rowMaxima[row]);
+  }
+  if (maxEntry == 0)
+    throw std::runtime_error("Matrix is the zero matrix.");
+  std::stable_sort(order.begin(), order.end(), [&rowMaxima](std::size_t a, std::size_t b)
+    {
+      return rowMaxima[a] > rowMaxima[b];
+    });
+  double scalingFactor = 1.0 / maxEntry;
+  double inactiveBound = 0.0;
+  for (std::size_t i = 0; i < order.size(); ++i)
+    inactiveBound += scalingFactor * rowMaxima[order[i]];
+  double gapLimit = options.gapLimit >= 0.0 ? options.gapLimit : (options.solver == "mwu" ? options.epsilon : 0.0);
+
+  // One LP is kept for all batches. New rows are appended to the submatrix, so that the nonzeros and rows of earlier batches keep
+  // their indices, and the cuts and rectangles found so far remain valid. Only the new rows are materialized.
+
+  std::unique_ptr<Slackmatrix> submatrix;
+  std::vector<Slackmatrix::Nonzero> nonzeros;
+  std::vector<std::uint64_t> rowIdentifiers;
+  std::vector<std::size_t> columns(matrix.numColumns());
+  for (std::size_t column = 0; column < columns.size(); ++column)
+    columns[column] = column;
+
+  std::unique_ptr<RectangleLibrary> library;
+  if (!options.rectangleLibrary.empty())
+    library.reset(new RectangleLibrary(options.rectangleLibrary));
+  cpm::Core core(createSolver(options));
+  core.setGapLimit(gapLimit);
+  core.setAdaptiveScheduling(options.adaptiveScheduling);
+  core.setVerbose(options.verbose);
+  core.setStoreInequalities(options.storeCuts || library != NULL);
+  if (options.progressCallback)
+  {
+    const BoundProgressCallback& callback = options.progressCallback;
+    core.setProgressCallback([&callback, &inactiveBound](const cpm::Core::Progress& coreProgress)
+      {
+        BoundProgress progress = { 0, coreProgress.time, coreProgress.round, coreProgress.primalBound,
+          coreProgress.dualBound + inactiveBound, coreProgress.numInequalities };
+        callback(progress);
+      });
+  }
+  core.setNameGenerator([&submatrix](std::size_t i)
+    {
+      std::stringstream ss;
+      ss << "nonzero#" << i << "#" << submatrix->nonzeros[i].row << "#" << submatrix->nonzeros[i].column;
+      return ss.str();
+    });
+  core.setRectangleExpander([&submatrix](const cpm::Rectangle& rectangle, std::vector<std::size_t>& indices)
+    {
+      submatrix->expandRectangle(rectangle, indices);
+    });
+
+  // Oracles and heuristics refer to the submatrix and are replaced for every batch.
+
+  std::vector<std::unique_ptr<cpm::SeparationOracle> > oracles;
+  std::unique_ptr<FoolingSetHeuristic> foolingSet;
+  BoundResult result;
+  std::size_t numActive = 0;
+  std::size_t numRounds = 0;
+  std::size_t numStoredRectangles = 0;
+  rows.clear();
+  while (true)
+  {
+    std::size_t oldNumActive = numActive;
+    std::size_t count = std::min(numActive + std::max<std::size_t>(options.activationRows, 1), order.size());
+    for (; numActive < count; ++numActive)
+      inactiveBound -= scalingFactor * rowMaxima[order[numActive]];
+    if (numActive == order.size())
+      inactiveBound = 0.0;
+    std::vector<std::size_t> newRows(order.begin() + oldNumActive, order.begin() + numActive);
+    rows.insert(rows.end(), newRows.begin(), newRows.end());
+
+    std::unique_ptr<Slackmatrix> part(matrix.materialize(newRows, columns));
+    std::size_t oldNumNonzeros = nonzeros.size();
+    for (std::size_t i = 0; i < part->nonzeros.size(); ++i)
+    {
+      nonzeros.push_back(part->nonzeros[i]);
+      nonzeros.back().row += oldNumActive;
+    }
+    rowIdentifiers.insert(rowIdentifiers.end(), part->rowIdentifiers.begin(), part->rowIdentifiers.end());
+
+    // The previous submatrix outlives the oracles and the heuristic that refer to it.
+
+    std::unique_ptr<Slackmatrix> previous(submatrix.release());
+    submatrix.reset(new Slackmatrix(numActive, matrix.numColumns(), nonzeros, rowIdentifiers, part->columnIdentifiers));
+
+    std::size_t numNew = nonzeros.size() - oldNumNonzeros;
+    std::vector<double> objective(numNew);
+    for (std::size_t i = 0; i < numNew; ++i)
+      objective[i] = scalingFactor * nonzeros[oldNumNonzeros + i].slack;
+    std::vector<double> lowerBounds(numNew, -std::numeric_limits<double>::infinity());
+    std::vector<double> upperBounds(numNew, 1.0);
+    core.addVariables(numNew, objective.data(), lowerBounds.data(), upperBounds.data());
+
+    // With nonzero activation, the initial nonzeros of the first batch are selected as usual, while those of later batches start
+    // inactive and are priced in by the LP.
+
+    if (!options.activation.empty())
+    {
+      std::vector<std::size_t> activeEntries;
+      if (oldNumActive == 0)
+        selectInitialEntries(*submatrix, options, NULL, activeEntries);
+      else
+      {
+        for (std::size_t i = 0; i < oldNumNonzeros; ++i)
+        {
+          if (core.isActive(i))
+            activeEntries.push_back(i);
+        }
+      }
+      core.setActiveVariables(activeEntries, options.activationBatch);
+    }
+
+    std::vector<std::unique_ptr<cpm::SeparationOracle> > newOracles;
+    std::shared_ptr<MaximumWeightRectangleIPModel> scipModel;
+    for (std::size_t o = 0; o < options.oracles.size(); ++o)
+    {
+      const std::string& name = options.oracles[o];
+      newOracles.push_back(std::unique_ptr<cpm::SeparationOracle>(createOracle(name, *submatrix, options, scipModel)));
+      if (oldNumActive > 0)
+        core.replaceOracle(o, newOracles.back().get());
+      else
+      {
+        std::map<std::string, double>::const_iterator budget = options.oracleTimeBudgets.find(name);
+        core.addOracle(newOracles.back().get(),
+          budget != options.oracleTimeBudgets.end() ? budget->second : std::numeric_limits<double>::infinity());
+      }
+    }
+    oracles.swap(newOracles);
+    if (options.foolingSet)
+    {
+      std::unique_ptr<FoolingSetHeuristic> newFoolingSet(new FoolingSetHeuristic(*submatrix, options.numThreads));
+      if (foolingSet)
+        core.replaceHeuristic(0, newFoolingSet.get());
+      else
+        core.addHeuristic(newFoolingSet.get());
+      foolingSet.swap(newFoolingSet);
+    }
+    if (library)
+    {
+      std::vector<cpm::Rectangle> stored;
+      library->findValid(*submatrix, stored);
+      core.addRectangles(stored);
+    }
+
+    core.run();
+
+    result.primalBound = std::max(core.primalBound(), 0.0);
+    result.dualBound = core.dualBound() + inactiveBound;
+    result.unproven = core.unproven();
+    numRounds += core.numRounds();
+    if (library)
+    {
+      for (; numStoredRectangles < core.rectangles().size(); ++numStoredRectangles)
+        library->append(*submatrix, core.rectangles()[numStoredRectangles]);
+    }
+    if (options.verbose)
+    {
+      std::cerr << "With " << numActive << " of " << matrix.numRows() << " rows active, the primal bound is " << result.primalBound
+        << " and the dual bound is " << result.dualBound << "." << std::endl;
+    }
+    if (numActive == order.size() || result.dualBound - result.primalBound <= gapLimit * result.dualBound)
+      break;
+  }
+
+  if (core.bestSolution())
+    result.point = core.bestSolution()->values;
+  else
+    result.point.assign(submatrix->nonzeros.size(), 0.0);
+  if (options.storeCuts)
+  {
+    for (std::size_t i = 0; i < core.inequalities().size(); ++i)
+      result.cuts.push_back(core.inequalities()[i].indices);
+    for (std::size_t i = 0; i < core.rectangles().size(); ++i)
+    {
+      result.cuts.push_back(std::vector<std::size_t>());
+      submatrix->expandRectangle(core.rectangles()[i], result.cuts.back());
+    }
+  }
+  result.statistics.numRounds = numRounds;
+  for (std::size_t o = 0; o < core.numOracles(); ++o)
+    result.statistics.oracles.push_back(core.oracleStatistics(o));
+  result.statistics.time = std::chrono::duration_cast<std::chrono::duration<double> >(std::chrono::steady_clock::now() - timeStart).count();
+  return result;
+}
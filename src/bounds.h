@@ -0,0 +1,179 @@
+#ifndef _BOUNDS_H_
+#define _BOUNDS_H_
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <cpm/core.h>
+
+#include "implicit_slackmatrix.h"
+#include "slackmatrix.h"
+
+struct BoundProgress
+{
+  std::size_t component;
+  double time;
+  std::size_t round;
+  double primalBound;
+  double dualBound;
+  std::size_t numCuts;
+};
+
+typedef std::function<void(const BoundProgress&)> BoundProgressCallback;
+
+struct BoundOptions
+{
+  std::string solver;
+  double epsilon;
+  double gapLimit;
+  std::vector<std::string> oracles;
+  std::map<std::string, double> oracleTimeBudgets;
+  bool adaptiveScheduling;
+  int cutLimit;
+  bool escalate;
+  bool restrictSupport;
+
+  /**
+   * If positive, SCIP oracles run in this many worker processes of workerExecutable, each for a range of first rows of the rectangle.
+   * An empty workerExecutable refers to oracle-worker next to the running executable.
+   */
+
+  std::size_t oracleProcesses;
+  std::string workerExecutable;
+
+  /**
+   * Run every oracle on its own thread and re-solve the LP as soon as asyncMinCuts cuts arrived.
+   */
+
+  bool asynchronous;
+  std::size_t asyncMinCuts;
+  bool foolingSet;
+  std::size_t subsetSize;
+  std::size_t subsetExactLimit;
+
+  /**
+   * Number of threads among which the subset oracle distributes its subproblems. The exact SCIP oracle likewise hands out blocks of
+   * first rows of the rectangles to as many solves on threads of their own.
+   */
+
+  std::size_t oracleThreads;
+  bool decompose;
+
+  /**
+   * Number of times the matrix is coarsened by clustering rows and columns whose supports have at least the given Jaccard
+   * similarity. The LP of the coarsest matrix is solved first, and each finer LP starts with the projected rectangles and point of
+   * the next coarser one.
+   */
+
+  std::size_t multilevel;
+  double multilevelSimilarity;
+
+  /**
+   * If not empty, the LP starts with a subset of the nonzeros, namely the activationBatch heaviest ones ("heaviest"), the heaviest
+   * one of every row and column ("diagonal") or a fooling set ("fooling-set"). The others are fixed to 0 and activated in batches of
+   * activationBatch once their reduced costs show that they can improve the LP.
+   */
+
+  std::string activation;
+  std::size_t activationBatch;
+
+  /**
+   * Number of rows added at once when an implicit matrix is solved by progressive row activation.
+   */
+
+  std::size_t activationRows;
+
+  /**
+   * Rows and columns are reordered by this method of computeOrdering ("rcm" or "weight") before solving, and points and cuts are
+   * mapped back. "none" keeps the given order.
+   */
+
+  std::string reorder;
+  std::size_t numThreads;
+  bool storeCuts;
+
+  /**
+   * File name of a rectangle library whose valid rectangles seed the LP and to which new rectangles are appended. Empty for none.
+   */
+
+  std::string rectangleLibrary;
+
+  /**
+   * File name to which the matrix and every separated point are recorded, suffixed by ".k" for the k'th component with k > 0. Empty
+   * for none.
+   */
+
+  std::string traceFile;
+  bool verbose;
+
+  /**
+   * Called after every round. When decomposing, it may be called concurrently for different components.
+   */
+
+  BoundProgressCallback progressCallback;
+
+  BoundOptions();
+};
+
+struct BoundStatistics
+{
+  double time;
+  std::size_t numComponents;
+  std::size_t numRounds;
+  std::vector<cpm::OracleStatistics> oracles;
+};
+
+struct BoundResult
+{
+  double primalBound;
+  double dualBound;
+
+  /**
+   * Set if the gap remained because oracles exhausted their time budgets, in which case the dual bound is not proven to be attained.
+   */
+
+  bool unproven;
+  std::vector<double> point;
+  std::vector<std::vector<std::size_t> > cuts;
+  BoundStatistics statistics;
+
+  BoundResult();
+};
+
+/**
+ * Computes bounds on the fractional rectangle covering LP of the given matrix. The point is feasible, has objective value primalBound
+ * and is indexed like the nonzeros. If requested, cuts contains every generated rectangle as a list of nonzero indices. Oracle
+ * statistics are indexed like options.oracles and summed over all components. Invalid options raise std::runtime_error.
+ */
+
+BoundResult computeBound(const Slackmatrix& slackmatrix, const BoundOptions& options);
+
+/**
+ * Creates the LP solver selected by the options. The caller owns it.
+ */
+
+cpm::Solver* createSolver(const BoundOptions& options);
+
+/**
+ * Creates the oracle of the given name, configured according to the options. The caller owns it.
+ */
+
+cpm::SeparationOracle* createOracle(const std::string& name, const Slackmatrix& slackmatrix, const BoundOptions& options);
+
+BoundResult computeBound(std::size_t numRows, std::size_t numColumns, const std::vector<Slackmatrix::Nonzero>& nonzeros,
+  const BoundOptions& options);
+
+/**
+ * Computes bounds for an implicit matrix by progressive row activation, without materializing it as a whole. The LP is solved for
+ * the activationRows rows with the heaviest entries, and further batches of rows are materialized and added to the same LP, keeping
+ * its cuts, until the gap limit is met. The dual bound adds the heaviest entry of every inactive row to the dual bound of the active
+ * rows, so with a gap limit of 0 all rows are activated eventually. Reordering, decomposition, multilevel mode and traces are not
+ * supported. On return, rows holds the active rows in the order of activation, and the point and cuts refer to the submatrix of these
+ * rows and all columns.
+ */
+
+BoundResult computeBound(ImplicitSlackmatrix& matrix, const BoundOptions& options, std::vector<std::size_t>& rows);
+
+#endif /* _BOUNDS_H_ */
@@ -0,0 +1,242 @@
+#include "coarsening.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <unordered_map>
+
+static std::uint64_t mixHash(std::uint64_t value)
+{
+  value += 0x9e3779b97f4a7c15ull;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+  return value ^ (value >> 31);
+}
+
+static std::size_t findRoot(std::vector<std::size_t>& parent, std::size_t node)
+{
+  while (parent[node] != node)
+  {
+    parent[node] = parent[parent[node]];
+    node = parent[node];
+  }
+  return node;
+}
+
+static double jaccardSimilarity(const std::vector<std::size_t>& first, const std::vector<std::size_t>& second)
+{
+  std::size_t common = 0;
+  std::size_t i = 0;
+  std::size_t j = 0;
+  while (i < first.size() && j < second.size())
+  {
+    if (first[i] < second[j])
+      ++i;
+    else if (first[i] > second[j])
+      ++j;
+    else
+    {
+      ++common;
+      ++i;
+      ++j;
+    }
+  }
+  return double(common) / double(first.size() + second.size() - common);
+}
+
+SlackmatrixCoarsening::SlackmatrixCoarsening(const Slackmatrix& slackmatrix, double similarity, std::size_t numBands,
+  std::size_t bandSize)
+  : _slackmatrix(slackmatrix), _coarse(NULL)
+{
+  std::vector<std::vector<std::size_t> > rowSupports(slackmatrix.numRows);
+  std::vector<std::vector<std::size_t> > columnSupports(slackmatrix.numColumns);
+  for (std::size_t i = 0; i < slackmatrix.nonzeros.size(); ++i)
+  {
+    rowSupports[slackmatrix.nonzeros[i].row].push_back(slackmatrix.nonzeros[i].column);
+    columnSupports[slackmatrix.nonzeros[i].column].push_back(slackmatrix.nonzeros[i].row);
+  }
+  for (std::size_t row = 0; row < slackmatrix.numRows; ++row)
+    std::sort(rowSupports[row].begin(), rowSupports[row].end());
+  for (std::size_t column = 0; column < slackmatrix.numColumns; ++column)
+    std::sort(columnSupports[column].begin(), columnSupports[column].end());
+
+  cluster(rowSupports, similarity, numBands, bandSize, _rowClusters);
+  cluster(columnSupports, similarity, numBands, bandSize, _columnClusters);
+
+  // The coarse matrix is the submatrix of the representatives.
+
+  const std::size_t none = std::numeric_limits<std::size_t>::max();
+  std::vector<Slackmatrix::Nonzero> nonzeros;
+  for (std::size_t r = 0; r < _rowClusters.size(); ++r)
+  {
+    const std::vector<std::size_t>& denseRow = slackmatrix.denseIndices[_rowClusters[r].front()];
+    for (std::size_t c = 0; c < _columnClusters.size(); ++c)
+    {
+      std::size_t i = denseRow[_columnClusters[c].front()];
+      if (i == none)
+        continue;
+
+      Slackmatrix::Nonzero nonzero = { r, c, slackmatrix.nonzeros[i].slack };
+      nonzeros.push_back(nonzero);
+      _nonzeros.push_back(i);
+    }
+  }
+
+  std::vector<std::uint64_t> rowIdentifiers(_rowClusters.size());
+  for (std::size_t r = 0; r < _rowClusters.size(); ++r)
+    rowIdentifiers[r] = slackmatrix.rowIdentifiers[_rowClusters[r].front()];
+  std::vector<std::uint64_t> columnIdentifiers(_columnClusters.size());
+  for (std::size_t c = 0; c < _columnClusters.size(); ++c)
+    columnIdentifiers[c] = slackmatrix.columnIdentifiers[_columnClusters[c].front()];
+  _coarse = new Slackmatrix(_rowClusters.size(), _columnClusters.size(), nonzeros, rowIdentifiers, columnIdentifiers);
+}
+
+SlackmatrixCoarsening::~SlackmatrixCoarsening()
+{
+  delete _coarse;
+}
+
+void SlackmatrixCoarsening::cluster(const std::vector<std::vector<std::size_t> >& supports, double similarity, std::size_t numBands,
+  std::size_t bandSize, std::vector<std::vector<std::size_t> >& clusters) const
+{
+  std::size_t numHashes = numBands * bandSize;
+  std::vector<std::size_t> parent(supports.size());
+  for (std::size_t i = 0; i < supports.size(); ++i)
+    parent[i] = i;
+
+  // MinHash signature per support, where hash function h maps element e to mixHash(e * numHashes + h).
+
+  std::vector<std::uint64_t> signatures(supports.size() * numHashes, std::numeric_limits<std::uint64_t>::max());
+  for (std::size_t i = 0; i < supports.size(); ++i)
+  {
+    std::uint64_t* signature = &signatures[i * numHashes];
+    for (std::size_t e = 0; e < supports[i].size(); ++e)
+    {
+      for (std::size_t h = 0; h < numHashes; ++h)
+        signature[h] = std::min(signature[h], mixHash(std::uint64_t(supports[i][e]) * numHashes + h));
+    }
+  }
+
+  // Supports agreeing on a whole band land in the same bucket, and each is compared to the first support in its bucket.
+
+  for (std::size_t band = 0; band < numBands; ++band)
+  {
+    std::unordered_map<std::uint64_t, std::size_t> buckets;
+    for (std::size_t i = 0; i < supports.size(); ++i)
+    {
+      if (supports[i].empty())
+        continue;
+
+      std::uint64_t key = band;
+      for (std::size_t h = band * bandSize; h < (band + 1) * bandSize; ++h)
+        key = mixHash(key ^ signatures[i * numHashes + h]);
+      std::pair<std::unordered_map<std::uint64_t, std::size_t>::iterator, bool> inserted = buckets.insert(std::make_pair(key, i));
+      if (inserted.second)
+        continue;
+
+      std::size_t leader = inserted.first->second;
+      std::size_t leaderRoot = findRoot(parent, leader);
+      std::size_t root = findRoot(parent, i);
+      if (leaderRoot != root && jaccardSimilarity(supports[leader], supports[i]) >= similarity)
+        parent[std::max(leaderRoot, root)] = std::min(leaderRoot, root);
+    }
+  }
+
+  // Clusters are ordered by their smallest element, and the element of largest support is moved to the front. Empty supports are
+  // dropped.
+
+  const std::size_t none = std::numeric_limits<std::size_t>::max();
+  std::vector<std::size_t> clusterOfRoot(supports.size(), none);
+  clusters.clear();
+  for (std::size_t i = 0; i < supports.size(); ++i)
+  {
+    if (supports[i].empty())
+      continue;
+
+    std::size_t root = findRoot(parent, i);
+    if (clusterOfRoot[root] == none)
+    {
+      clusterOfRoot[root] = clusters.size();
+      clusters.push_back(std::vector<std::size_t>());
+    }
+    std::vector<std::size_t>& members = clusters[clusterOfRoot[root]];
+    members.push_back(i);
+    if (supports[i].size() > supports[members.front()].size())
+      std::swap(members.front(), members.back());
+  }
+}
+
+void SlackmatrixCoarsening::projectRectangle(const cpm::Rectangle& coarseRectangle, cpm::Rectangle& rectangle) const
+{
+  const std::size_t none = std::numeric_limits<std::size_t>::max();
+  rectangle.rows.clear();
+  rectangle.columns.clear();
+  for (std::size_t r = 0; r < coarseRectangle.rows.size(); ++r)
+    rectangle.rows.push_back(_rowClusters[coarseRectangle.rows[r]].front());
+  for (std::size_t c = 0; c < coarseRectangle.columns.size(); ++c)
+    rectangle.columns.push_back(_columnClusters[coarseRectangle.columns[c]].front());
+
+  // Add the other members of the column clusters that are nonzero in all rows, and then those of the row clusters.
+
+  for (std::size_t c = 0; c < coarseRectangle.columns.size(); ++c)
+  {
+    const std::vector<std::size_t>& members = _columnClusters[coarseRectangle.columns[c]];
+    for (std::size_t m = 1; m < members.size(); ++m)
+    {
+      std::size_t r = 0;
+      while (r < coarseRectangle.rows.size() && _slackmatrix.denseIndices[rectangle.rows[r]][members[m]] != none)
+        ++r;
+      if (r == coarseRectangle.rows.size())
+        rectangle.columns.push_back(members[m]);
+    }
+  }
+  for (std::size_t r = 0; r < coarseRectangle.rows.size(); ++r)
+  {
+    const std::vector<std::size_t>& members = _rowClusters[coarseRectangle.rows[r]];
+    for (std::size_t m = 1; m < members.size(); ++m)
+    {
+      const std::vector<std::size_t>& denseRow = _slackmatrix.denseIndices[members[m]];
+      std::size_t c = 0;
+      while (c < rectangle.columns.size() && denseRow[rectangle.columns[c]] != none)
+        ++c;
+      if (c == rectangle.columns.size())
+        rectangle.rows.push_back(members[m]);
+    }
+  }
+  rectangle.normalize();
+}
+
+void SlackmatrixCoarsening::projectPoint(const std::vector<double>& coarsePoint, std::vector<double>& point) const
+{
+  assert(coarsePoint.size() == _nonzeros.size());
+  point.assign(_slackmatrix.nonzeros.size(), 0.0);
+  for (std::size_t i = 0; i < _nonzeros.size(); ++i)
+    point[_nonzeros[i]] = coarsePoint[i];
+}
+
+FixedPointHeuristic::FixedPointHeuristic(const std::vector<double>& point)
+  : PrimalHeuristic(point.size()), _point(point)
+{
+
+}
+
+FixedPointHeuristic::~FixedPointHeuristic()
+{
+
+}
+
+void FixedPointHeuristic::run()
+{
+
+}
+
+std::size_t FixedPointHeuristic::numFeasiblePoints() const
+{
+  return 1;
+}
+
+void FixedPointHeuristic::getFeasiblePoint(std::size_t id, std::vector<double>& point) const
+{
+  assert(id == 0);
+  point = _point;
+}
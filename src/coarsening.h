@@ -0,0 +1,76 @@
+#ifndef _COARSENING_H_
+#define _COARSENING_H_
+
+#include <vector>
+
+#include <cpm/primal_heuristic.h>
+#include <cpm/rectangle.h>
+
+#include "slackmatrix.h"
+
+/**
+ * Clusters rows and columns of a slack matrix with similar supports and represents each cluster by its row or column of largest
+ * support. Candidate pairs are found by MinHash signatures with banded locality-sensitive hashing and merged if the Jaccard similarity
+ * of their supports is at least the given threshold. The coarse matrix is the submatrix of the representatives, so every feasible
+ * point of its LP extends by zeros to a feasible point of the original LP with the same objective value, and every coarse rectangle
+ * is a rectangle of the original matrix, which is enlarged by the other members of its clusters where possible.
+ */
+
+class SlackmatrixCoarsening
+{
+public:
+  SlackmatrixCoarsening(const Slackmatrix& slackmatrix, double similarity = 0.8, std::size_t numBands = 8,
+    std::size_t bandSize = 4);
+
+  ~SlackmatrixCoarsening();
+
+  inline const Slackmatrix& coarse() const
+  {
+    return *_coarse;
+  }
+
+  /**
+   * Maps a rectangle of the coarse matrix to one of the original matrix that contains it.
+   */
+
+  void projectRectangle(const cpm::Rectangle& coarseRectangle, cpm::Rectangle& rectangle) const;
+
+  /**
+   * Maps a point indexed like the coarse nonzeros to one indexed like the original nonzeros, with zeros outside the representatives.
+   */
+
+  void projectPoint(const std::vector<double>& coarsePoint, std::vector<double>& point) const;
+
+protected:
+  void cluster(const std::vector<std::vector<std::size_t> >& supports, double similarity, std::size_t numBands, std::size_t bandSize,
+    std::vector<std::vector<std::size_t> >& clusters) const;
+
+  const Slackmatrix& _slackmatrix;
+  Slackmatrix* _coarse;
+  std::vector<std::vector<std::size_t> > _rowClusters;
+  std::vector<std::vector<std::size_t> > _columnClusters;
+  std::vector<std::size_t> _nonzeros;
+};
+
+/**
+ * Heuristic returning a fixed point, e.g., one projected from a coarse matrix.
+ */
+
+class FixedPointHeuristic : public cpm::PrimalHeuristic
+{
+public:
+  FixedPointHeuristic(const std::vector<double>& point);
+
+  virtual ~FixedPointHeuristic();
+
+  virtual void run();
+
+  virtual std::size_t numFeasiblePoints() const;
+
+  virtual void getFeasiblePoint(std::size_t id, std::vector<double>& point) const;
+
+protected:
+  std::vector<double> _point;
+};
+
+#endif /* _COARSENING_H_ */
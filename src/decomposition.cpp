@@ -0,0 +1,193 @@
+#include "decomposition.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <mutex>
+#include <iostream>
+
+static std::size_t findRoot(std::vector<std::size_t>& parent, std::size_t node)
+{
+  while (parent[node] != node)
+  {
+    parent[node] = parent[parent[node]];
+    node = parent[node];
+  }
+  return node;
+}
+
+void findComponents(const Slackmatrix& slackmatrix, std::vector<SlackmatrixComponent>& components)
+{
+  // Union-find on rows 0, ..., m-1 and columns m, ..., m+n-1.
+
+  std::vector<std::size_t> parent(slackmatrix.numRows + slackmatrix.numColumns);
+  for (std::size_t i = 0; i < parent.size(); ++i)
+    parent[i] = i;
+  for (std::size_t i = 0; i < slackmatrix.nonzeros.size(); ++i)
+  {
+    std::size_t rowRoot = findRoot(parent, slackmatrix.nonzeros[i].row);
+    std::size_t columnRoot = findRoot(parent, slackmatrix.numRows + slackmatrix.nonzeros[i].column);
+    if (rowRoot != columnRoot)
+      parent[std::max(rowRoot, columnRoot)] = std::min(rowRoot, columnRoot);
+  }
+
+  components.clear();
+  std::vector<std::size_t> componentOfRoot(parent.size(), std::numeric_limits<std::size_t>::max());
+  for (std::size_t i = 0; i < slackmatrix.nonzeros.size(); ++i)
+  {
+    std::size_t root = findRoot(parent, slackmatrix.nonzeros[i].row);
+    if (componentOfRoot[root] == std::numeric_limits<std::size_t>::max())
+    {
+      componentOfRoot[root] = components.size();
+      components.push_back(SlackmatrixComponent());
+    }
+    components[componentOfRoot[root]].nonzeros.push_back(i);
+  }
+  for (std::size_t row = 0; row < slackmatrix.numRows; ++row)
+  {
+    std::size_t c = componentOfRoot[findRoot(parent, row)];
+    if (c != std::numeric_limits<std::size_t>::max())
+      components[c].rows.push_back(row);
+  }
+  for (std::size_t column = 0; column < slackmatrix.numColumns; ++column)
+  {
+    std::size_t c = componentOfRoot[findRoot(parent, slackmatrix.numRows + column)];
+    if (c != std::numeric_limits<std::size_t>::max())
+      components[c].columns.push_back(column);
+  }
+}
+
+Slackmatrix extractComponent(const Slackmatrix& slackmatrix, const SlackmatrixComponent& component)
+{
+  std::vector<std::size_t> localRows(slackmatrix.numRows, std::numeric_limits<std::size_t>::max());
+  std::vector<std::size_t> localColumns(slackmatrix.numColumns, std::numeric_limits<std::size_t>::max());
+  for (std::size_t r = 0; r < component.rows.size(); ++r)
+    localRows[component.rows[r]] = r;
+  for (std::size_t c = 0; c < component.columns.size(); ++c)
+    localColumns[component.columns[c]] = c;
+
+  std::vector<Slackmatrix::Nonzero> nonzeros(component.nonzeros.size());
+  for (std::size_t i = 0; i < component.nonzeros.size(); ++i)
+  {
+    const Slackmatrix::Nonzero& nonzero = slackmatrix.nonzeros[component.nonzeros[i]];
+    nonzeros[i].row = localRows[nonzero.row];
+    nonzeros[i].column = localColumns[nonzero.column];
+    nonzeros[i].slack = nonzero.slack;
+  }
+
+  std::vector<std::uint64_t> rowIdentifiers(component.rows.size());
+  for (std::size_t r = 0; r < component.rows.size(); ++r)
+    rowIdentifiers[r] = slackmatrix.rowIdentifiers[component.rows[r]];
+  std::vector<std::uint64_t> columnIdentifiers(component.columns.size());
+  for (std::size_t c = 0; c < component.columns.size(); ++c)
+    columnIdentifiers[c] = slackmatrix.columnIdentifiers[component.columns[c]];
+
+  return Slackmatrix(component.rows.size(), component.columns.size(), nonzeros, rowIdentifiers, columnIdentifiers);
+}
+
+void solveComponents(const Slackmatrix& slackmatrix, const std::vector<SlackmatrixComponent>& components, double scalingFactor,
+  const ComponentSolver& solver, std::size_t numThreads, BoundResult& result)
+{
+  // Largest components first for better load balancing.
+
+  std::vector<std::size_t> order(components.size());
+  for (std::size_t c = 0; c < components.size(); ++c)
+    order[c] = c;
+  std::sort(order.begin(), order.end(), [&components](std::size_t a, std::size_t b)
+    {
+      return components[a].nonzeros.size() > components[b].nonzeros.size();
+    });
+
+  // Every worker holds one thread of the budget until it runs out of components.
+
+  std::size_t numWorkers = std::max<std::size_t>(std::min(numThreads, components.size()), 1);
+  ThreadBudget threadBudget(std::max(numThreads, numWorkers) - numWorkers);
+  std::vector<BoundResult> results(components.size());
+  std::atomic<std::size_t> next(0);
+  std::mutex exceptionMutex;
+  std::exception_ptr exception;
+  auto worker = [&]()
+  {
+    for (std::size_t i = next++; i < order.size(); i = next++)
+    {
+      const SlackmatrixComponent& component = components[order[i]];
+      BoundResult& componentResult = results[order[i]];
+      try
+      {
+        if (component.isTrivial())
+        {
+          std::size_t best = 0;
+          for (std::size_t j = 1; j < component.nonzeros.size(); ++j)
+          {
+            if (slackmatrix.nonzeros[component.nonzeros[j]].slack > slackmatrix.nonzeros[component.nonzeros[best]].slack)
+              best = j;
+          }
+          componentResult.point.assign(component.nonzeros.size(), 0.0);
+          componentResult.point[best] = 1.0;
+          componentResult.primalBound = componentResult.dualBound = scalingFactor * slackmatrix.nonzeros[component.nonzeros[best]].slack;
+        }
+        else
+          solver(order[i], extractComponent(slackmatrix, component), &threadBudget, componentResult);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(exceptionMutex);
+        if (!exception)
+          exception = std::current_exception();
+      }
+    }
+    threadBudget.release(1);
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t t = 1; t < numWorkers; ++t)
+    threads.push_back(std::thread(worker));
+  worker();
+  for (std::size_t t = 0; t < threads.size(); ++t)
+    threads[t].join();
+  if (exception)
+    std::rethrow_exception(exception);
+
+  // Sum up bounds and map points and cuts back to the nonzeros of the whole matrix.
+
+  result.primalBound = 0.0;
+  result.dualBound = 0.0;
+  result.unproven = false;
+  result.point.assign(slackmatrix.nonzeros.size(), 0.0);
+  result.cuts.clear();
+  result.statistics.numComponents = components.size();
+  result.statistics.numRounds = 0;
+  for (std::size_t c = 0; c < components.size(); ++c)
+  {
+    const BoundResult& componentResult = results[c];
+    const std::vector<std::size_t>& nonzeros = components[c].nonzeros;
+    result.primalBound += std::max(componentResult.primalBound, 0.0);
+    result.dualBound += componentResult.dualBound;
+    result.unproven = result.unproven || componentResult.unproven;
+    for (std::size_t i = 0; i < componentResult.point.size() && i < nonzeros.size(); ++i)
+      result.point[nonzeros[i]] = componentResult.point[i];
+    for (std::size_t i = 0; i < componentResult.cuts.size(); ++i)
+    {
+      result.cuts.push_back(std::vector<std::size_t>(componentResult.cuts[i].size()));
+      for (std::size_t j = 0; j < componentResult.cuts[i].size(); ++j)
+        result.cuts.back()[j] = nonzeros[componentResult.cuts[i][j]];
+    }
+
+    result.statistics.numRounds += componentResult.statistics.numRounds;
+    for (std::size_t o = 0; o < componentResult.statistics.oracles.size(); ++o)
+    {
+      const cpm::OracleStatistics& stats = componentResult.statistics.oracles[o];
+      if (o >= result.statistics.oracles.size())
+        result.statistics.oracles.push_back(cpm::OracleStatistics(stats.timeBudget));
+      cpm::OracleStatistics& total = result.statistics.oracles[o];
+      total.numCalls += stats.numCalls;
+      total.numSkips += stats.numSkips;
+      total.numSuccesses += stats.numSuccesses;
+      total.numCuts += stats.numCuts;
+      total.time += stats.time;
+      total.violation += stats.violation;
+    }
+  }
+}
@@ -0,0 +1,47 @@
+#ifndef _DECOMPOSITION_H_
+#define _DECOMPOSITION_H_
+
+#include <functional>
+
+#include "slackmatrix.h"
+#include "bounds.h"
+#include "thread_budget.h"
+
+struct SlackmatrixComponent
+{
+  std::vector<std::size_t> rows;
+  std::vector<std::size_t> columns;
+  std::vector<std::size_t> nonzeros;
+
+  /**
+   * Returns true if every rectangle is contained in a single row or column, in which case the LP is solved by the heaviest entry.
+   */
+
+  inline bool isTrivial() const
+  {
+    return rows.size() == 1 || columns.size() == 1;
+  }
+};
+
+typedef std::function<void(std::size_t index, const Slackmatrix& component, ThreadBudget* threadBudget, BoundResult& result)>
+  ComponentSolver;
+
+/**
+ * Computes the connected components of the bipartite row/column support graph. Rows and columns without nonzeros are ignored.
+ */
+
+void findComponents(const Slackmatrix& slackmatrix, std::vector<SlackmatrixComponent>& components);
+
+Slackmatrix extractComponent(const Slackmatrix& slackmatrix, const SlackmatrixComponent& component);
+
+/**
+ * Solves all components on numThreads threads and combines their results. Trivial components are solved directly, the others by
+ * calling the given solver, which must be thread-safe. The solver may start further threads only by taking them from the given
+ * budget, which receives the threads of workers that ran out of components. Points and cuts of the combined result are indexed like
+ * the nonzeros of slackmatrix.
+ */
+
+void solveComponents(const Slackmatrix& slackmatrix, const std::vector<SlackmatrixComponent>& components, double scalingFactor,
+  const ComponentSolver& solver, std::size_t numThreads, BoundResult& result);
+
+#endif /* _DECOMPOSITION_H_ */
@@ -1,16 +1,16 @@
 #include "enum_oracle.h"
 
+#include <algorithm>
 #include <cassert>
 #include <limits>
 #include <iostream>
 
 MaximumWeightRectangleEnumOracle::MaximumWeightRectangleEnumOracle(const Slackmatrix& slackmatrix, int priority)
-  : SeparationOracle(slackmatrix.nonzeros.size(), priority)
+  : SeparationOracle(slackmatrix.nonzeros.size(), priority), _bound(slackmatrix)
 {
   _slackmatrix = new Slackmatrix(slackmatrix.numRows, slackmatrix.numColumns, slackmatrix.nonzeros);
   _sumPositiveByRow.resize(_slackmatrix->numRows);
   _sumPositiveByColumn.resize(_slackmatrix->numColumns);
-  _variables.reserve(2 * std::max(_slackmatrix->numRows, _slackmatrix->numColumns));
 }
 
 MaximumWeightRectangleEnumOracle::~MaximumWeightRectangleEnumOracle()
@@ -25,6 +25,15 @@ void MaximumWeightRectangleEnumOracle::separate(bool separatePoint, const double
 {
   assert(separatePoint);
 
+  _rectangles.clear();
+  separateRectangles(vector, _rectangles, violationLowerBound, violationUpperBound);
+  _slackmatrix->appendInequalities(_rectangles, lhs, rhs, begin, indices, values);
+}
+
+bool MaximumWeightRectangleEnumOracle::separateRectangles(const double* vector, std::vector<cpm::Rectangle>& rectangles,
+  double& violationLowerBound, double& violationUpperBound)
+{
+  std::size_t oldNumRectangles = rectangles.size();
   for (std::size_t r = 0; r < _slackmatrix->numRows; ++r)
     _sumPositiveByRow[r] = 0.0;
   for (std::size_t c = 0; c < _slackmatrix->numColumns; ++c)
@@ -49,9 +58,8 @@ void MaximumWeightRectangleEnumOracle::separate(bool separatePoint, const double
     double violation = _sumPositiveByRow[r] - 1.0;
     if (violation > 1.0e-3)
     {
-      lhs.push_back(-std::numeric_limits<double>::infinity());
-      rhs.push_back(1.0);
-      begin.push_back(indices.size());
+      rectangles.push_back(cpm::Rectangle());
+      rectangles.back().rows.push_back(r);
       for (std::size_t c = 0; c < _slackmatrix->numColumns; ++c)
       {
         std::size_t v = _slackmatrix->denseIndices[r][c];
@@ -59,10 +67,7 @@ void MaximumWeightRectangleEnumOracle::separate(bool separatePoint, const double
           continue;
 
         if (vector[v] > 0.0)
-        {
-          indices.push_back(v);
-          values.push_back(1.0);
-        }
+          rectangles.back().columns.push_back(c);
       }
       if (violation > violationLowerBound)
         violationLowerBound = violation;
@@ -76,9 +81,8 @@ void MaximumWeightRectangleEnumOracle::separate(bool separatePoint, const double
     double violation = _sumPositiveByColumn[c] - 1.0;
     if (violation > 1.0e-3)
     {
-      lhs.push_back(-std::numeric_limits<double>::infinity());
-      rhs.push_back(1.0);
-      begin.push_back(indices.size());
+      rectangles.push_back(cpm::Rectangle());
+      rectangles.back().columns.push_back(c);
       for (std::size_t r = 0; r < _slackmatrix->numRows; ++r)
       {
         std::size_t v = _slackmatrix->denseIndices[r][c];
@@ -86,10 +90,7 @@ void MaximumWeightRectangleEnumOracle::separate(bool separatePoint, const double
           continue;
 
         if (vector[v] > 0.0)
-        {
-          indices.push_back(v);
-          values.push_back(1.0);
-        }
+          rectangles.back().rows.push_back(r);
       }
       if (violation > violationLowerBound)
         violationLowerBound = violation;
@@ -98,8 +99,9 @@ void MaximumWeightRectangleEnumOracle::separate(bool separatePoint, const double
 
   // Check pairs of rows.
 
-  if (lhs.empty())
+  if (rectangles.size() == oldNumRectangles)
   {
+    cpm::Rectangle rectangle;
     for (std::size_t r1 = 0; r1 < _slackmatrix->numRows; ++r1)
     {
       for (std::size_t r2 = r1 + 1; r2 < _slackmatrix->numRows; ++r2)
@@ -107,8 +109,7 @@ void MaximumWeightRectangleEnumOracle::separate(bool separatePoint, const double
         if (_sumPositiveByRow[r1] + _sumPositiveByRow[r2] - 1.0 <= 1.0e-3)
           continue;
 
-//         std::cerr << "Candidate row pair " << r1 << " " << r2 << std::endl;
-        _variables.clear();
+        rectangle.columns.clear();
         double violation = -1.0;
         for (std::size_t c = 0; c < _slackmatrix->numColumns; ++c)
         {
@@ -123,21 +124,15 @@ void MaximumWeightRectangleEnumOracle::separate(bool separatePoint, const double
           if (contribution > 0.0)
           {
             violation += contribution;
-            _variables.push_back(v1);
-            _variables.push_back(v2);
+            rectangle.columns.push_back(c);
           }
         }
         
         if (violation > 1.0e-3)
         {
-          lhs.push_back(-std::numeric_limits<double>::infinity());
-          rhs.push_back(1.0);
-          begin.push_back(indices.size());
-          for (std::size_t i = 0; i < _variables.size(); ++i)
-          {
-            indices.push_back(_variables[i]);
-            values.push_back(1.0);
-          }
+          rectangle.rows.assign(1, r1);
+          rectangle.rows.push_back(r2);
+          rectangles.push_back(rectangle);
         }
       }
     }
@@ -145,8 +140,9 @@ void MaximumWeightRectangleEnumOracle::separate(bool separatePoint, const double
 
   // Check pairs of columns.
 
-  if (lhs.empty())
+  if (rectangles.size() == oldNumRectangles)
   {
+    cpm::Rectangle rectangle;
     for (std::size_t c1 = 0; c1 < _slackmatrix->numColumns; ++c1)
     {
       for (std::size_t c2 = c1 + 1; c2 < _slackmatrix->numColumns; ++c2)
@@ -154,8 +150,7 @@ void MaximumWeightRectangleEnumOracle::separate(bool separatePoint, const double
         if (_sumPositiveByColumn[c1] + _sumPositiveByColumn[c2] - 1.0 <= 1.0e-3)
           continue;
 
-//         std::cerr << "Candidate column pair " << c1 << " " << c2 << std::endl;
-        _variables.clear();
+        rectangle.rows.clear();
         double violation = -1.0;
         for (std::size_t r = 0; r < _slackmatrix->numRows; ++r)
         {
@@ -170,24 +165,46 @@ void MaximumWeightRectangleEnumOracle::separate(bool separatePoint, const double
           if (contribution > 0.0)
           {
             violation += contribution;
-            _variables.push_back(v1);
-            _variables.push_back(v2);
+            rectangle.rows.push_back(r);
           }
         }
         
         if (violation > 1.0e-3)
         {
-          lhs.push_back(-std::numeric_limits<double>::infinity());
-          rhs.push_back(1.0);
-          begin.push_back(indices.size());
-          for (std::size_t i = 0; i < _variables.size(); ++i)
-          {
-            indices.push_back(_variables[i]);
-            values.push_back(1.0);
-          }
+          rectangle.columns.assign(1, c1);
+          rectangle.columns.push_back(c2);
+          rectangles.push_back(rectangle);
         }
       }
     }
   }
+
+  // A certified bound on the maximum rectangle weight turns the point into a feasible one.
+
+  double maxWeight = std::max(_bound.crossBound(vector, 4 * _slackmatrix->nonzeros.size()), 1.0);
+  violationUpperBound = std::min(violationUpperBound, maxWeight - 1.0);
+  _feasiblePoint.resize(ambientDimension());
+  for (std::size_t v = 0; v < ambientDimension(); ++v)
+    _feasiblePoint[v] = vector[v] / maxWeight;
+
+  return true;
+}
+
+void MaximumWeightRectangleEnumOracle::getFeasiblePointProperties(bool& scaledDown, bool& scaledUp,
+  std::vector<std::size_t>& modifiableVariables) const
+{
+  cpm::SeparationOracle::getFeasiblePointProperties(scaledDown, scaledUp, modifiableVariables);
+  scaledDown = true;
 }
 
+std::size_t MaximumWeightRectangleEnumOracle::numFeasiblePoints() const
+{
+  return _feasiblePoint.empty() ? 0 : 1;
+}
+
+void MaximumWeightRectangleEnumOracle::getFeasiblePoint(std::size_t id, std::vector<double>& point) const
+{
+  assert(id == 0);
+  assert(!_feasiblePoint.empty());
+  point = _feasiblePoint;
+}
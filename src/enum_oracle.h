@@ -4,6 +4,7 @@
 #include <cpm/separation_oracle.h>
 
 #include "slackmatrix.h"
+#include "weight_bound.h"
 
 class MaximumWeightRectangleEnumOracle : public cpm::SeparationOracle
 {
@@ -16,11 +17,22 @@ public:
     std::vector<std::size_t>& begin, std::vector<std::size_t>& indices, std::vector<double>& values, double& violationLowerBound,
     double& violationUpperBound);
 
+  virtual bool separateRectangles(const double* vector, std::vector<cpm::Rectangle>& rectangles, double& violationLowerBound,
+    double& violationUpperBound);
+
+  virtual void getFeasiblePointProperties(bool& scaledDown, bool& scaledUp, std::vector< std::size_t >& modifiableVariables) const;
+
+  virtual std::size_t numFeasiblePoints() const;
+
+  virtual void getFeasiblePoint(std::size_t id, std::vector<double>& point) const;
+
 protected:
   const Slackmatrix* _slackmatrix;
   std::vector<double> _sumPositiveByRow;
   std::vector<double> _sumPositiveByColumn;
-  std::vector<std::size_t> _variables;
+  std::vector<cpm::Rectangle> _rectangles;
+  MaximumWeightRectangleBound _bound;
+  std::vector<double> _feasiblePoint;
 };
 
 #endif /* _ENUM_ORACLE_H_ */
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "fooling_set.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <limits>
+#include <random>
+#include <thread>
+
+FoolingSetHeuristic::FoolingSetHeuristic(const Slackmatrix& slackmatrix, std::size_t numThreads, ThreadBudget* threadBudget)
+  : PrimalHeuristic(slackmatrix.nonzeros.size()), _slackmatrix(slackmatrix), _numThreads(std::max<std::size_t>(numThreads, 1)),
+  _threadBudget(threadBudget)
+{
+
+}
+
+FoolingSetHeuristic::~FoolingSetHeuristic()
+{
+
+}
+
+double FoolingSetHeuristic::greedy(const std::vector<std::size_t>& order, std::vector<std::size_t>& foolingSet) const
+{
+  // Two nonzeros (r,c) and (r',c') are compatible if they share no line and (r,c') or (r',c) is zero.
+
+  const std::size_t none = std::numeric_limits<std::size_t>::max();
+  std::vector<bool> rowUsed(_slackmatrix.numRows, false);
+  std::vector<bool> columnUsed(_slackmatrix.numColumns, false);
+  foolingSet.clear();
+  double weight = 0.0;
+  for (std::size_t i = 0; i < order.size(); ++i)
+  {
+    const Slackmatrix::Nonzero& candidate = _slackmatrix.nonzeros[order[i]];
+    if (rowUsed[candidate.row] || columnUsed[candidate.column])
+      continue;
+
+    const std::vector<std::size_t>& candidateRow = _slackmatrix.denseIndices[candidate.row];
+    bool compatible = true;
+    for (std::size_t j = 0; j < foolingSet.size() && compatible; ++j)
+    {
+      const Slackmatrix::Nonzero& member = _slackmatrix.nonzeros[foolingSet[j]];
+      compatible = candidateRow[member.column] == none || _slackmatrix.denseIndices[member.row][candidate.column] == none;
+    }
+    if (!compatible)
+      continue;
+
+    foolingSet.push_back(order[i]);
+    rowUsed[candidate.row] = true;
+    columnUsed[candidate.column] = true;
+    weight += candidate.slack;
+  }
+  return weight;
+}
+
+void FoolingSetHeuristic::run()
+{
+  std::size_t numNonzeros = _slackmatrix.nonzeros.size();
+  std::vector<std::size_t> rowSizes(_slackmatrix.numRows, 0);
+  std::vector<std::size_t> columnSizes(_slackmatrix.numColumns, 0);
+  for (std::size_t i = 0; i < numNonzeros; ++i)
+  {
+    ++rowSizes[_slackmatrix.nonzeros[i].row];
+    ++columnSizes[_slackmatrix.nonzeros[i].column];
+  }
+
+  // Order 0 prefers heavy entries, order 1 heavy entries in sparse lines, and all others perturb the latter randomly.
+
+  std::size_t numOrders = std::max<std::size_t>(_numThreads, 2);
+  std::vector<std::vector<std::size_t> > foolingSets(numOrders);
+  std::vector<double> weights(numOrders, -1.0);
+  std::atomic<std::size_t> next(0);
+  auto greedyOrder = [&](std::size_t t)
+  {
+    std::vector<double> key(numNonzeros);
+    std::mt19937 random(t);
+    std::uniform_real_distribution<double> perturbation(0.5, 1.5);
+    for (std::size_t i = 0; i < numNonzeros; ++i)
+    {
+      const Slackmatrix::Nonzero& nonzero = _slackmatrix.nonzeros[i];
+      key[i] = nonzero.slack;
+      if (t > 0)
+        key[i] /= rowSizes[nonzero.row] + columnSizes[nonzero.column] - 1;
+      if (t > 1)
+        key[i] *= perturbation(random);
+    }
+    std::vector<std::size_t> order(numNonzeros);
+    for (std::size_t i = 0; i < numNonzeros; ++i)
+      order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&key](std::size_t a, std::size_t b)
+      {
+        return key[a] > key[b];
+      });
+    weights[t] = greedy(order, foolingSets[t]);
+  };
+  auto worker = [&]()
+  {
+    for (std::size_t t = next++; t < numOrders; t = next++)
+      greedyOrder(t);
+  };
+
+  ThreadReservation reservation(_threadBudget, _numThreads - 1);
+  std::vector<std::thread> threads;
+  for (std::size_t t = 1; t < reservation.numThreads(); ++t)
+    threads.push_back(std::thread(worker));
+  worker();
+  for (std::size_t t = 0; t < threads.size(); ++t)
+    threads[t].join();
+
+  std::size_t best = std::max_element(weights.begin(), weights.end()) - weights.begin();
+  _foolingSet.swap(foolingSets[best]);
+}
+
+std::size_t FoolingSetHeuristic::numFeasiblePoints() const
+{
+  return _foolingSet.empty() ? 0 : 1;
+}
+
+void FoolingSetHeuristic::getFeasiblePoint(std::size_t id, std::vector<double>& point) const
+{
+  assert(id == 0);
+  point.assign(ambientDimension(), 0.0);
+  for (std::size_t i = 0; i < _foolingSet.size(); ++i)
+    point[_foolingSet[i]] = 1.0;
+}
@@ -0,0 +1,42 @@
+#ifndef _FOOLING_SET_H_
+#define _FOOLING_SET_H_
+
+#include <cpm/primal_heuristic.h>
+
+#include "slackmatrix.h"
+#include "thread_budget.h"
+
+/**
+ * Greedily computes a heavy fooling set, i.e., a set of nonzeros no two of which lie in a common all-nonzero rectangle. Its
+ * incidence vector is feasible for the LP. Several greedy orders are tried in parallel and the heaviest set is kept. With a thread
+ * budget, the threads beyond the calling one are taken from it, while the orders tried only depend on numThreads.
+ */
+
+class FoolingSetHeuristic : public cpm::PrimalHeuristic
+{
+public:
+  FoolingSetHeuristic(const Slackmatrix& slackmatrix, std::size_t numThreads = 1, ThreadBudget* threadBudget = NULL);
+
+  virtual ~FoolingSetHeuristic();
+
+  virtual void run();
+
+  virtual std::size_t numFeasiblePoints() const;
+
+  virtual void getFeasiblePoint(std::size_t id, std::vector<double>& point) const;
+
+  inline const std::vector<std::size_t>& foolingSet() const
+  {
+    return _foolingSet;
+  }
+
+protected:
+  double greedy(const std::vector<std::size_t>& order, std::vector<std::size_t>& foolingSet) const;
+
+  const Slackmatrix& _slackmatrix;
+  std::size_t _numThreads;
+  ThreadBudget* _threadBudget;
+  std::vector<std::size_t> _foolingSet;
+};
+
+#endif /* _FOOLING_SET_H_ */
@@ -0,0 +1,340 @@
+#include "implicit_slackmatrix.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+ImplicitSlackmatrix::ImplicitSlackmatrix(std::size_t numRows, std::size_t numColumns, std::size_t blockSize,
+  std::size_t maxCachedBlocks)
+  : _numRows(numRows), _numColumns(numColumns), _blockSize(std::max<std::size_t>(blockSize, 1)),
+  _maxCachedBlocks(std::max<std::size_t>(maxCachedBlocks, 1)), _rowIdentifiers(numRows), _columnIdentifiers(numColumns)
+{
+  _numBlockColumns = (numColumns + _blockSize - 1) / _blockSize;
+  for (std::size_t row = 0; row < numRows; ++row)
+    _rowIdentifiers[row] = row;
+  for (std::size_t column = 0; column < numColumns; ++column)
+    _columnIdentifiers[column] = column;
+}
+
+ImplicitSlackmatrix::~ImplicitSlackmatrix()
+{
+
+}
+
+const ImplicitSlackmatrix::Block& ImplicitSlackmatrix::block(std::size_t blockRow, std::size_t blockColumn)
+{
+  std::uint64_t key = blockRow * _numBlockColumns + blockColumn;
+  std::unordered_map<std::uint64_t, Block>::iterator iter = _blocks.find(key);
+  if (iter != _blocks.end())
+  {
+    _recentBlocks.splice(_recentBlocks.begin(), _recentBlocks, iter->second.position);
+    return iter->second;
+  }
+
+  std::size_t rowBegin = blockRow * _blockSize;
+  std::size_t rowEnd = std::min(rowBegin + _blockSize, _numRows);
+  std::size_t columnBegin = blockColumn * _blockSize;
+  std::size_t columnEnd = std::min(columnBegin + _blockSize, _numColumns);
+  std::vector<std::size_t> slacks((rowEnd - rowBegin) * (columnEnd - columnBegin));
+  computeBlock(rowBegin, rowEnd, columnBegin, columnEnd, slacks.data());
+
+  // Evict the least recently used block if the cache is full.
+
+  if (_blocks.size() >= _maxCachedBlocks)
+  {
+    _blocks.erase(_recentBlocks.back());
+    _recentBlocks.pop_back();
+  }
+
+  Block& result = _blocks[key];
+  result.slacks.swap(slacks);
+  _recentBlocks.push_front(key);
+  result.position = _recentBlocks.begin();
+  return result;
+}
+
+std::size_t ImplicitSlackmatrix::slack(std::size_t row, std::size_t column)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::size_t columnBegin = (column / _blockSize) * _blockSize;
+  std::size_t width = std::min(columnBegin + _blockSize, _numColumns) - columnBegin;
+  return block(row / _blockSize, column / _blockSize).slacks[(row % _blockSize) * width + (column - columnBegin)];
+}
+
+void ImplicitSlackmatrix::rowSupport(std::size_t row, std::vector<std::size_t>& columns)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (std::size_t blockColumn = 0; blockColumn < _numBlockColumns; ++blockColumn)
+  {
+    std::size_t columnBegin = blockColumn * _blockSize;
+    std::size_t width = std::min(columnBegin + _blockSize, _numColumns) - columnBegin;
+    const std::size_t* slacks = &block(row / _blockSize, blockColumn).slacks[(row % _blockSize) * width];
+    for (std::size_t c = 0; c < width; ++c)
+    {
+      if (slacks[c] > 0)
+        columns.push_back(columnBegin + c);
+    }
+  }
+}
+
+bool ImplicitSlackmatrix::isRectangle(const std::vector<std::size_t>& rows, const std::vector<std::size_t>& columns)
+{
+  for (std::size_t r = 0; r < rows.size(); ++r)
+  {
+    for (std::size_t c = 0; c < columns.size(); ++c)
+    {
+      if (slack(rows[r], columns[c]) == 0)
+        return false;
+    }
+  }
+  return true;
+}
+
+Slackmatrix* ImplicitSlackmatrix::materialize(const std::vector<std::size_t>& rows, const std::vector<std::size_t>& columns)
+{
+  std::vector<Slackmatrix::Nonzero> nonzeros;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (std::size_t r = 0; r < rows.size(); ++r)
+    {
+      if (rows[r] >= _numRows)
+        throw std::runtime_error("ImplicitSlackmatrix: Row index out of range.");
+      for (std::size_t c = 0; c < columns.size(); ++c)
+      {
+        if (columns[c] >= _numColumns)
+          throw std::runtime_error("ImplicitSlackmatrix: Column index out of range.");
+        std::size_t columnBegin = (columns[c] / _blockSize) * _blockSize;
+        std::size_t width = std::min(columnBegin + _blockSize, _numColumns) - columnBegin;
+        std::size_t slack = block(rows[r] / _blockSize, columns[c] / _blockSize).slacks[(rows[r] % _blockSize) * width
+          + (columns[c] - columnBegin)];
+        if (slack > 0)
+        {
+          Slackmatrix::Nonzero nz = { r, c, slack };
+          nonzeros.push_back(nz);
+        }
+      }
+    }
+  }
+
+  std::vector<std::uint64_t> rowIdentifiers(rows.size());
+  for (std::size_t r = 0; r < rows.size(); ++r)
+    rowIdentifiers[r] = _rowIdentifiers[rows[r]];
+  std::vector<std::uint64_t> columnIdentifiers(columns.size());
+  for (std::size_t c = 0; c < columns.size(); ++c)
+    columnIdentifiers[c] = _columnIdentifiers[columns[c]];
+  return new Slackmatrix(rows.size(), columns.size(), nonzeros, rowIdentifiers, columnIdentifiers);
+}
+
+void ImplicitSlackmatrix::scanRows(std::size_t numThreads,
+  const std::function<void(std::size_t, std::size_t, std::size_t, const std::size_t*)>& visit)
+{
+  // Threads fetch blocks of rows, so all calls for a row come from the same thread.
+
+  std::size_t numBlockRows = (_numRows + _blockSize - 1) / _blockSize;
+  std::atomic<std::size_t> nextBlockRow(0);
+  std::exception_ptr exception;
+  std::mutex exceptionMutex;
+  auto worker = [&]()
+  {
+    std::vector<std::size_t> slacks;
+    try
+    {
+      for (std::size_t blockRow = nextBlockRow++; blockRow < numBlockRows; blockRow = nextBlockRow++)
+      {
+        std::size_t rowBegin = blockRow * _blockSize;
+        std::size_t rowEnd = std::min(rowBegin + _blockSize, _numRows);
+        for (std::size_t columnBegin = 0; columnBegin < _numColumns; columnBegin += _blockSize)
+        {
+          std::size_t columnEnd = std::min(columnBegin + _blockSize, _numColumns);
+          std::size_t width = columnEnd - columnBegin;
+          slacks.resize((rowEnd - rowBegin) * width);
+          computeBlock(rowBegin, rowEnd, columnBegin, columnEnd, slacks.data());
+          for (std::size_t row = rowBegin; row < rowEnd; ++row)
+            visit(row, columnBegin, width, &slacks[(row - rowBegin) * width]);
+        }
+      }
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(exceptionMutex);
+      if (!exception)
+        exception = std::current_exception();
+      nextBlockRow = numBlockRows;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t t = 1; t < std::max<std::size_t>(numThreads, 1); ++t)
+    threads.push_back(std::thread(worker));
+  worker();
+  for (std::size_t t = 0; t < threads.size(); ++t)
+    threads[t].join();
+  if (exception)
+    std::rethrow_exception(exception);
+}
+
+void ImplicitSlackmatrix::materialize(std::vector<Slackmatrix::Nonzero>& nonzeros, std::size_t numThreads)
+{
+  // Every row collects its nonzeros separately, since its blocks may be visited in any order relative to other rows. The rows are
+  // concatenated in order afterwards.
+
+  std::vector<std::vector<Slackmatrix::Nonzero> > rowNonzeros(_numRows);
+  scanRows(numThreads, [&rowNonzeros](std::size_t row, std::size_t columnBegin, std::size_t width, const std::size_t* slacks)
+    {
+      for (std::size_t c = 0; c < width; ++c)
+      {
+        if (slacks[c] > 0)
+        {
+          Slackmatrix::Nonzero nz = { row, columnBegin + c, slacks[c] };
+          rowNonzeros[row].push_back(nz);
+        }
+      }
+    });
+
+  std::size_t numNonzeros = 0;
+  for (std::size_t row = 0; row < _numRows; ++row)
+    numNonzeros += rowNonzeros[row].size();
+  nonzeros.clear();
+  nonzeros.reserve(numNonzeros);
+  for (std::size_t row = 0; row < _numRows; ++row)
+  {
+    nonzeros.insert(nonzeros.end(), rowNonzeros[row].begin(), rowNonzeros[row].end());
+    std::vector<Slackmatrix::Nonzero>().swap(rowNonzeros[row]);
+  }
+}
+
+void ImplicitSlackmatrix::rowMaxima(std::vector<std::size_t>& maxima, std::size_t numThreads)
+{
+  maxima.assign(_numRows, 0);
+  scanRows(numThreads, [&maxima](std::size_t row, std::size_t columnBegin, std::size_t width, const std::size_t* slacks)
+    {
+      for (std::size_t c = 0; c < width; ++c)
+        maxima[row] = std::max(maxima[row], slacks[c]);
+    });
+}
+
+/* FNV-1a hash of integral data, which identifies inequalities and vertices across polytope files. */
+
+static std::uint64_t hashValues(const long long* values, std::size_t count)
+{
+  std::uint64_t result = 14695981039346656037ULL;
+  for (std::size_t i = 0; i < count; ++i)
+    result = (result ^ static_cast<std::uint64_t>(values[i])) * 1099511628211ULL;
+  return result;
+}
+
+PolytopeSlackmatrix::PolytopeSlackmatrix(std::size_t dimension, const std::vector<long long>& vertices,
+  const std::vector<long long>& inequalities, std::size_t blockSize, std::size_t maxCachedBlocks)
+  : ImplicitSlackmatrix(inequalities.size() / (dimension + 1), dimension > 0 ? vertices.size() / dimension : 0, blockSize,
+  maxCachedBlocks), _dimension(dimension), _vertices(vertices), _inequalities(inequalities)
+{
+  if (dimension == 0 || vertices.size() % dimension != 0 || inequalities.size() % (dimension + 1) != 0)
+    throw std::runtime_error("PolytopeSlackmatrix: Sizes of vertex or inequality data do not match the dimension.");
+
+  // Coordinate-major vertex data lets the inner loop run over consecutive vertices. The magnitudes decide per block whether 64 bits
+  // suffice, since |b - a^T v| <= |b| + max_d |a_d| * sum_d |v_d|.
+
+  std::size_t numVertices = numColumns();
+  _vertexCoordinates.resize(vertices.size());
+  _vertexAbsSums.assign(numVertices, 0);
+  for (std::size_t v = 0; v < numVertices; ++v)
+  {
+    unsigned __int128 sum = 0;
+    for (std::size_t d = 0; d < dimension; ++d)
+    {
+      long long coordinate = vertices[v * dimension + d];
+      _vertexCoordinates[d * numVertices + v] = coordinate;
+      sum += coordinate < 0 ? -(unsigned __int128) coordinate : (unsigned __int128) coordinate;
+    }
+    _vertexAbsSums[v] = sum > std::numeric_limits<unsigned long long>::max() ? std::numeric_limits<unsigned long long>::max()
+      : (unsigned long long) sum;
+  }
+  _inequalityMaxAbs.assign(numRows(), 0);
+  for (std::size_t i = 0; i < numRows(); ++i)
+  {
+    for (std::size_t d = 0; d <= dimension; ++d)
+    {
+      long long value = inequalities[i * (dimension + 1) + d];
+      unsigned long long absValue = value < 0 ? -(unsigned long long) value : (unsigned long long) value;
+      _inequalityMaxAbs[i] = std::max(_inequalityMaxAbs[i], absValue);
+    }
+  }
+
+  for (std::size_t i = 0; i < numRows(); ++i)
+    _rowIdentifiers[i] = hashValues(&inequalities[i * (dimension + 1)], dimension + 1);
+  for (std::size_t v = 0; v < numVertices; ++v)
+    _columnIdentifiers[v] = hashValues(&vertices[v * dimension], dimension);
+}
+
+PolytopeSlackmatrix::~PolytopeSlackmatrix()
+{
+
+}
+
+void PolytopeSlackmatrix::computeBlock(std::size_t rowBegin, std::size_t rowEnd, std::size_t columnBegin, std::size_t columnEnd,
+  std::size_t* slacks) const
+{
+  unsigned long long maxInequality = 0;
+  for (std::size_t row = rowBegin; row < rowEnd; ++row)
+    maxInequality = std::max(maxInequality, _inequalityMaxAbs[row]);
+  unsigned long long maxVertex = 0;
+  for (std::size_t column = columnBegin; column < columnEnd; ++column)
+    maxVertex = std::max(maxVertex, _vertexAbsSums[column]);
+  if ((unsigned __int128) maxInequality * ((unsigned __int128) maxVertex + 1) < ((unsigned __int128) 1 << 62))
+  {
+    std::size_t width = columnEnd - columnBegin;
+    std::size_t numVertices = numColumns();
+    std::vector<long long> rowSlacks(width);
+    for (std::size_t row = rowBegin; row < rowEnd; ++row)
+    {
+      const long long* inequality = &_inequalities[row * (_dimension + 1)];
+      std::fill(rowSlacks.begin(), rowSlacks.end(), inequality[0]);
+      for (std::size_t d = 0; d < _dimension; ++d)
+      {
+        long long coefficient = inequality[1 + d];
+        if (coefficient == 0)
+          continue;
+        const long long* coordinates = &_vertexCoordinates[d * numVertices + columnBegin];
+        for (std::size_t c = 0; c < width; ++c)
+          rowSlacks[c] -= coefficient * coordinates[c];
+      }
+      for (std::size_t c = 0; c < width; ++c)
+      {
+        if (rowSlacks[c] < 0)
+        {
+          std::stringstream ss;
+          ss << "PolytopeSlackmatrix: Slack of inequality " << row << " and vertex " << (columnBegin + c) << " is negative.";
+          throw std::runtime_error(ss.str());
+        }
+        *slacks++ = (std::size_t) rowSlacks[c];
+      }
+    }
+    return;
+  }
+
+  for (std::size_t row = rowBegin; row < rowEnd; ++row)
+  {
+    const long long* inequality = &_inequalities[row * (_dimension + 1)];
+    for (std::size_t column = columnBegin; column < columnEnd; ++column)
+    {
+      // Slack b - a^T v, computed with 128 bits to detect overflow.
+
+      const long long* vertex = &_vertices[column * _dimension];
+      __int128 slack = inequality[0];
+      for (std::size_t d = 0; d < _dimension; ++d)
+        slack -= (__int128) inequality[1 + d] * vertex[d];
+      if (slack < 0 || slack > (__int128) std::numeric_limits<long long>::max())
+      {
+        std::stringstream ss;
+        ss << "PolytopeSlackmatrix: Slack of inequality " << row << " and vertex " << column << " is "
+          << (slack < 0 ? "negative" : "too large") << ".";
+        throw std::runtime_error(ss.str());
+      }
+      *slacks++ = (std::size_t) slack;
+    }
+  }
+}
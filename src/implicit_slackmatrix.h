@@ -0,0 +1,152 @@
+#ifndef _IMPLICIT_SLACKMATRIX_H_
+#define _IMPLICIT_SLACKMATRIX_H_
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "slackmatrix.h"
+
+/**
+ * Slack matrix whose entries are computed on demand by a generator instead of being stored. Entries are computed block-wise, and a
+ * bounded number of recently used blocks is cached. All queries are thread-safe.
+ */
+
+class ImplicitSlackmatrix
+{
+public:
+  ImplicitSlackmatrix(std::size_t numRows, std::size_t numColumns, std::size_t blockSize = 64, std::size_t maxCachedBlocks = 4096);
+
+  virtual ~ImplicitSlackmatrix();
+
+  inline std::size_t numRows() const
+  {
+    return _numRows;
+  }
+
+  inline std::size_t numColumns() const
+  {
+    return _numColumns;
+  }
+
+  /**
+   * Persistent identifiers of the rows and columns as in Slackmatrix. They default to the indices.
+   */
+
+  inline const std::vector<std::uint64_t>& rowIdentifiers() const
+  {
+    return _rowIdentifiers;
+  }
+
+  inline const std::vector<std::uint64_t>& columnIdentifiers() const
+  {
+    return _columnIdentifiers;
+  }
+
+  /**
+   * Returns the slack of the given row and column.
+   */
+
+  std::size_t slack(std::size_t row, std::size_t column);
+
+  /**
+   * Appends the columns with nonzero slack in the given row.
+   */
+
+  void rowSupport(std::size_t row, std::vector<std::size_t>& columns);
+
+  /**
+   * Returns true if all entries of the rectangle are nonzero.
+   */
+
+  bool isRectangle(const std::vector<std::size_t>& rows, const std::vector<std::size_t>& columns);
+
+  /**
+   * Materializes the submatrix of the given rows and columns, which keep their identifiers.
+   */
+
+  Slackmatrix* materialize(const std::vector<std::size_t>& rows, const std::vector<std::size_t>& columns);
+
+  /**
+   * Sets nonzeros to the nonzeros of the whole matrix in row-major order, computing blocks of rows on numThreads threads and
+   * bypassing the cache. No dense index table is built.
+   */
+
+  void materialize(std::vector<Slackmatrix::Nonzero>& nonzeros, std::size_t numThreads = 1);
+
+  /**
+   * Sets maxima to the maximum slack of every row, computing blocks of rows on numThreads threads and bypassing the cache.
+   */
+
+  void rowMaxima(std::vector<std::size_t>& maxima, std::size_t numThreads = 1);
+
+protected:
+  /**
+   * Computes the slacks of rows [rowBegin, rowEnd) and columns [columnBegin, columnEnd) in row-major order.
+   */
+
+  virtual void computeBlock(std::size_t rowBegin, std::size_t rowEnd, std::size_t columnBegin, std::size_t columnEnd,
+    std::size_t* slacks) const = 0;
+
+  struct Block
+  {
+    std::vector<std::size_t> slacks;
+    std::list<std::uint64_t>::iterator position;
+  };
+
+  const Block& block(std::size_t blockRow, std::size_t blockColumn);
+
+  /**
+   * Computes all blocks without caching them and passes every row of a block to visit(row, columnBegin, width, slacks). Blocks of
+   * rows are distributed over numThreads threads, and all calls for a row come from the same thread.
+   */
+
+  void scanRows(std::size_t numThreads, const std::function<void(std::size_t, std::size_t, std::size_t, const std::size_t*)>& visit);
+
+  std::size_t _numRows;
+  std::size_t _numColumns;
+  std::size_t _blockSize;
+  std::size_t _numBlockColumns;
+  std::size_t _maxCachedBlocks;
+  std::vector<std::uint64_t> _rowIdentifiers;
+  std::vector<std::uint64_t> _columnIdentifiers;
+  std::unordered_map<std::uint64_t, Block> _blocks;
+  std::list<std::uint64_t> _recentBlocks;
+  std::mutex _mutex;
+};
+
+/**
+ * Slack matrix of a polytope given by its vertices and an inequality description a^T x <= b with integral data. Rows correspond to
+ * inequalities and columns to vertices, and their identifiers are hashes of the coefficients and coordinates, so that they match
+ * across descriptions of related polytopes, e.g., of the same family at growing size. Blocks are computed with 64-bit arithmetic over coordinate-major vertex data if the
+ * magnitudes permit it, and with 128-bit arithmetic otherwise.
+ */
+
+class PolytopeSlackmatrix : public ImplicitSlackmatrix
+{
+public:
+  /**
+   * Vertices are given row-wise as numVertices x dimension values, inequalities as numInequalities x (1 + dimension) values (b, a).
+   */
+
+  PolytopeSlackmatrix(std::size_t dimension, const std::vector<long long>& vertices, const std::vector<long long>& inequalities,
+    std::size_t blockSize = 64, std::size_t maxCachedBlocks = 4096);
+
+  virtual ~PolytopeSlackmatrix();
+
+protected:
+  virtual void computeBlock(std::size_t rowBegin, std::size_t rowEnd, std::size_t columnBegin, std::size_t columnEnd,
+    std::size_t* slacks) const;
+
+  std::size_t _dimension;
+  std::vector<long long> _vertices;
+  std::vector<long long> _inequalities;
+  std::vector<long long> _vertexCoordinates;
+  std::vector<unsigned long long> _inequalityMaxAbs;
+  std::vector<unsigned long long> _vertexAbsSums;
+};
+
+#endif /* _IMPLICIT_SLACKMATRIX_H_ */
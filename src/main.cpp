@@ -1,77 +1,374 @@
-
-#include <cpm/core.h>
-#include <cpm/solver_soplex.h>
-#include <cpm/separation_oracle.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cassert>
+#include <cstdlib>
+#include <cctype>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
 
 #include "slackmatrix.h"
-#include "enum_oracle.h"
-#include "scip_oracle.h"
+#include "implicit_slackmatrix.h"
+#include "bounds.h"
+#include "bound_server.h"
+#include "submatrix_search.h"
+
+/* Reads count whitespace-separated identifiers from the given file. */
+
+static void readIdentifiers(const std::string& fileName, std::size_t count, std::vector<std::uint64_t>& identifiers)
+{
+  std::ifstream file(fileName.c_str());
+  identifiers.resize(count);
+  for (std::size_t i = 0; i < count; ++i)
+    file >> identifiers[i];
+  if (!file)
+    throw std::runtime_error("Cannot read " + std::to_string(count) + " identifiers from <" + fileName + ">.");
+}
+
+void printUsage(const char* program)
+{
+  std::cerr << "Usage: " << program << " [OPTIONS] MATRIX-FILE\n";
+  std::cerr << "       " << program << " [OPTIONS] --polytope POLYTOPE-FILE\n";
+  std::cerr << "Options:\n";
+  std::cerr << "  --polytope FILE      Generate the slack matrix from a file with the dimension d, the numbers of vertices and\n";
+  std::cerr << "                       inequalities, the vertices (d integers each) and the inequalities (b and a for a^T x <= b).\n";
+  std::cerr << "                       With --activation, batches of --activation-rows rows are activated instead.\n";
+  std::cerr << "  --solver NAME        LP engine for the master problem among soplex, portfolio (racing SoPlex\n";
+  std::cerr << "                       configurations on up to 4 threads) and mwu (default: soplex). Since mwu clamps the\n";
+  std::cerr << "                       lower bounds of the entries to 0, its bounds refer to a different LP than those of soplex.\n";
+  std::cerr << "  --epsilon EPS        Accuracy of the multiplicative-weights engine (default: 0.1).\n";
+  std::cerr << "  --gap GAP            Stop as soon as the relative gap is at most GAP (default: 0, or EPS for mwu).\n";
+  std::cerr << "  --oracles LIST       Comma-separated oracles among enum, subset, heuristic and exact (default: enum,exact).\n";
+  std::cerr << "  --subset-size K      Maximum subset size of the subset oracle (default: 3).\n";
+  std::cerr << "  --subset-exact N     Let the subset oracle enumerate all subsets if the shorter side has at most N elements (default: 24).\n";
+  std::cerr << "  --oracle-threads N   Number of threads of the subset and exact oracles (default: 1).\n";
+  std::cerr << "  --budget NAME=SEC    Total time budget for the given oracle.\n";
+  std::cerr << "  --cut-limit K        Interrupt SCIP oracles once K violated rectangles were found (default: 0 = never).\n";
+  std::cerr << "  --escalate           Let SCIP oracles try node limits 1, 1000 and 100000 before solving exactly.\n";
+  std::cerr << "  --restrict-support   Let SCIP oracles fix rows and columns without positive LP weight and lift the rectangles.\n";
+  std::cerr << "  --oracle-processes N Run SCIP oracles in N worker processes, partitioned by the first row of the rectangle.\n";
+  std::cerr << "  --static             Call oracles strictly by priority, without adaptive reordering and skipping.\n";
+  std::cerr << "  --async [K]          Run oracles on separate threads and re-solve the LP once K cuts arrived (default: 1).\n";
+  std::cerr << "                       Requires the soplex solver.\n";
+  std::cerr << "  --no-fooling-set     Do not compute an initial primal bound from a fooling set.\n";
+  std::cerr << "  --library FILE       Seed the LP with valid rectangles from FILE and append the new ones to it. Rows and columns\n";
+  std::cerr << "                       are identified by their indices, or by hashes of the inequalities and vertices with --polytope.\n";
+  std::cerr << "  --row-identifiers FILE\n";
+  std::cerr << "  --column-identifiers FILE\n";
+  std::cerr << "                       Read one 64-bit identifier per row or column of MATRIX-FILE for --library.\n";
+  std::cerr << "  --server             Keep the LP and oracles resident and answer requests from stdin (see bound_server.h).\n";
+  std::cerr << "  --socket PATH        Like --server, but answer requests from clients of a Unix socket at PATH.\n";
+  std::cerr << "  --trace FILE         Record the matrix and every separated point to FILE for separation-replay.\n";
+  std::cerr << "  --decompose          Solve connected components of the support independently.\n";
+  std::cerr << "  --multilevel L       Solve L times coarsened matrices first, each seeding the next finer LP.\n";
+  std::cerr << "  --multilevel-similarity S\n";
+  std::cerr << "                       Minimum Jaccard similarity of clustered rows and columns (default: 0.8).\n";
+  std::cerr << "  --reorder rcm|weight|none\n";
+  std::cerr << "                       Solve with rows and columns reordered by reverse Cuthill-McKee on the support graph or by\n";
+  std::cerr << "                       decreasing weight (default: none).\n";
+  std::cerr << "  --activation heaviest|diagonal|fooling-set\n";
+  std::cerr << "                       Start the LP with a subset of the nonzeros and activate others by reduced cost.\n";
+  std::cerr << "  --activation-batch N Number of nonzeros activated at once (default: 1000).\n";
+  std::cerr << "  --activation-rows N  Number of polytope rows activated at once (default: 1000).\n";
+  std::cerr << "  --threads N          Number of components solved in parallel (default: number of cores).\n";
+  std::cerr << "  --submatrix-search RxC\n";
+  std::cerr << "                       Concurrently search for lower bounds from LPs of RxC submatrices.\n";
+  std::cerr << "  --submatrix-selection random|weight|violated\n";
+  std::cerr << "                       Selection of submatrices (default: weight).\n";
+  std::cerr << std::flush;
+}
 
 int main(int argc, char** argv)
 {
-  std::string fileName = argv[1];
+  std::string fileName;
+  bool polytope = false;
+  BoundOptions options;
+  options.verbose = true;
+  std::string oracleNames = "enum,exact";
+  SubmatrixSearchOptions searchOptions;
+  bool submatrixSearch = false;
+  bool server = false;
+  std::string serverSocket;
+  std::string rowIdentifierFile;
+  std::string columnIdentifierFile;
+  for (int a = 1; a < argc; ++a)
+  {
+    std::string arg = argv[a];
+    if (arg == "--solver" && a + 1 < argc)
+      options.solver = argv[++a];
+    else if (arg == "--epsilon" && a + 1 < argc)
+      options.epsilon = atof(argv[++a]);
+    else if (arg == "--gap" && a + 1 < argc)
+      options.gapLimit = atof(argv[++a]);
+    else if (arg == "--oracles" && a + 1 < argc)
+      oracleNames = argv[++a];
+    else if (arg == "--subset-size" && a + 1 < argc)
+      options.subsetSize = std::max(1, atoi(argv[++a]));
+    else if (arg == "--subset-exact" && a + 1 < argc)
+      options.subsetExactLimit = std::max(0, atoi(argv[++a]));
+    else if (arg == "--oracle-threads" && a + 1 < argc)
+      options.oracleThreads = std::max(1, atoi(argv[++a]));
+    else if (arg == "--budget" && a + 1 < argc && std::string(argv[a + 1]).find('=') != std::string::npos)
+    {
+      std::string budget = argv[++a];
+      std::size_t pos = budget.find('=');
+      options.oracleTimeBudgets[budget.substr(0, pos)] = atof(budget.substr(pos + 1).c_str());
+    }
+    else if (arg == "--static")
+      options.adaptiveScheduling = false;
+    else if (arg == "--cut-limit" && a + 1 < argc)
+      options.cutLimit = atoi(argv[++a]);
+    else if (arg == "--escalate")
+      options.escalate = true;
+    else if (arg == "--restrict-support")
+      options.restrictSupport = true;
+    else if (arg == "--oracle-processes" && a + 1 < argc)
+      options.oracleProcesses = std::max(0, atoi(argv[++a]));
+    else if (arg == "--async")
+    {
+      options.asynchronous = true;
+      if (a + 1 < argc && isdigit(argv[a + 1][0]))
+        options.asyncMinCuts = std::max(1, atoi(argv[++a]));
+    }
+    else if (arg == "--no-fooling-set")
+      options.foolingSet = false;
+    else if (arg == "--library" && a + 1 < argc)
+      options.rectangleLibrary = argv[++a];
+    else if (arg == "--row-identifiers" && a + 1 < argc)
+      rowIdentifierFile = argv[++a];
+    else if (arg == "--column-identifiers" && a + 1 < argc)
+      columnIdentifierFile = argv[++a];
+    else if (arg == "--server")
+      server = true;
+    else if (arg == "--socket" && a + 1 < argc)
+    {
+      server = true;
+      serverSocket = argv[++a];
+    }
+    else if (arg == "--trace" && a + 1 < argc)
+      options.traceFile = argv[++a];
+    else if (arg == "--decompose")
+      options.decompose = true;
+    else if (arg == "--multilevel" && a + 1 < argc)
+      options.multilevel = std::max(0, atoi(argv[++a]));
+    else if (arg == "--multilevel-similarity" && a + 1 < argc)
+      options.multilevelSimilarity = atof(argv[++a]);
+    else if (arg == "--reorder" && a + 1 < argc)
+      options.reorder = argv[++a];
+    else if (arg == "--activation" && a + 1 < argc)
+      options.activation = argv[++a];
+    else if (arg == "--activation-batch" && a + 1 < argc)
+      options.activationBatch = std::max(1, atoi(argv[++a]));
+    else if (arg == "--activation-rows" && a + 1 < argc)
+      options.activationRows = std::max(1, atoi(argv[++a]));
+    else if (arg == "--threads" && a + 1 < argc)
+      options.numThreads = std::max(1, atoi(argv[++a]));
+    else if (arg == "--submatrix-search" && a + 1 < argc && std::string(argv[a + 1]).find('x') != std::string::npos)
+    {
+      std::string size = argv[++a];
+      searchOptions.numRows = std::max(1, atoi(size.substr(0, size.find('x')).c_str()));
+      searchOptions.numColumns = std::max(1, atoi(size.substr(size.find('x') + 1).c_str()));
+      submatrixSearch = true;
+    }
+    else if (arg == "--submatrix-selection" && a + 1 < argc)
+      searchOptions.selection = argv[++a];
+    else if (arg == "--polytope" && a + 1 < argc && fileName.empty())
+    {
+      fileName = argv[++a];
+      polytope = true;
+    }
+    else if (fileName.empty() && arg.substr(0, 2) != "--")
+      fileName = arg;
+    else
+    {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (fileName.empty() || (options.solver != "soplex" && options.solver != "portfolio" && options.solver != "mwu")
+    || (polytope && (!rowIdentifierFile.empty() || !columnIdentifierFile.empty())))
+  {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  options.oracles.clear();
+  std::stringstream oracleStream(oracleNames);
+  std::string name;
+  while (std::getline(oracleStream, name, ','))
+    options.oracles.push_back(name);
   
   std::size_t numRows, numColumns;
   std::vector<Slackmatrix::Nonzero> nonzeros;
   std::ifstream file(fileName.c_str());
-  file >> numRows >> numColumns;
-  unsigned int maxEntry = 0.0;
-  for (std::size_t row = 0; row < numRows; ++row)
+  std::size_t maxEntry = 0;
+  std::vector<std::uint64_t> rowIdentifiers;
+  std::vector<std::uint64_t> columnIdentifiers;
+  if (polytope)
+  {
+    // With progressive activation, the LP is only built for growing subsets of the rows. Otherwise the nonzeros are extracted, with
+    // blocks of rows computed in parallel, and the dense index table of the slack matrix below is filled in parallel as well.
+
+    std::size_t dimension, numVertices, numInequalities;
+    file >> dimension >> numVertices >> numInequalities;
+    std::vector<long long> vertices(numVertices * dimension);
+    for (std::size_t i = 0; i < vertices.size(); ++i)
+      file >> vertices[i];
+    std::vector<long long> inequalities(numInequalities * (dimension + 1));
+    for (std::size_t i = 0; i < inequalities.size(); ++i)
+      file >> inequalities[i];
+    if (!file)
+    {
+      std::cerr << "Error: cannot read polytope from <" << fileName << ">." << std::endl;
+      return EXIT_FAILURE;
+    }
+    try
+    {
+      PolytopeSlackmatrix implicit(dimension, vertices, inequalities);
+      if (!options.activation.empty() && !server && !submatrixSearch)
+      {
+        std::cout << "Generated " << implicit.numRows() << "x" << implicit.numColumns() << " matrix." << std::endl;
+        std::vector<std::size_t> activeRows;
+        BoundResult result = computeBound(implicit, options, activeRows);
+        std::cout << "Primal bound: " << result.primalBound << ", dual bound: " << result.dualBound << " with " << activeRows.size()
+          << " rows active." << std::endl;
+        if (result.unproven)
+          std::cout << "Warning: Oracles exhausted their time budgets, so the bounds are not proven to be optimal." << std::endl;
+        return EXIT_SUCCESS;
+      }
+      numRows = implicit.numRows();
+      numColumns = implicit.numColumns();
+      implicit.materialize(nonzeros, options.numThreads);
+      rowIdentifiers = implicit.rowIdentifiers();
+      columnIdentifiers = implicit.columnIdentifiers();
+    }
+    catch (std::exception& e)
+    {
+      std::cerr << "Error: " << e.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (std::size_t i = 0; i < nonzeros.size(); ++i)
+      maxEntry = std::max(maxEntry, nonzeros[i].slack);
+  }
+  else
   {
-    for (std::size_t column = 0; column < numColumns; ++column)
+    file >> numRows >> numColumns;
+    for (std::size_t row = 0; row < numRows; ++row)
     {
-      unsigned int slack;
-      file >> slack;
-      assert(slack >= 0);
-      if (slack > 0)
+      for (std::size_t column = 0; column < numColumns; ++column)
       {
-        Slackmatrix::Nonzero nz = { row, column, slack };
-        nonzeros.push_back(nz);
-        maxEntry = std::max(maxEntry, slack);
+        unsigned int slack;
+        file >> slack;
+        assert(slack >= 0);
+        if (slack > 0)
+        {
+          Slackmatrix::Nonzero nz = { row, column, slack };
+          nonzeros.push_back(nz);
+          maxEntry = std::max<std::size_t>(maxEntry, slack);
+        }
       }
     }
+    try
+    {
+      if (!rowIdentifierFile.empty())
+        readIdentifiers(rowIdentifierFile, numRows, rowIdentifiers);
+      if (!columnIdentifierFile.empty())
+        readIdentifiers(columnIdentifierFile, numColumns, columnIdentifiers);
+    }
+    catch (std::exception& e)
+    {
+      std::cerr << "Error: " << e.what() << std::endl;
+      return EXIT_FAILURE;
+    }
   }
-  Slackmatrix slackmatrix(numRows, numColumns, nonzeros);
+  Slackmatrix slackmatrix(numRows, numColumns, std::move(nonzeros), options.numThreads);
+  if (!rowIdentifiers.empty())
+    slackmatrix.rowIdentifiers = rowIdentifiers;
+  if (!columnIdentifiers.empty())
+    slackmatrix.columnIdentifiers = columnIdentifiers;
   file.close();
 
-  std::cout << "Read " << numRows << "x" << numColumns << " matrix with " << nonzeros.size() << " nonzeros." << std::endl;
+  std::cout << "Read " << numRows << "x" << numColumns << " matrix with " << slackmatrix.nonzeros.size() << " nonzeros." << std::endl;
 
   if (maxEntry == 0)
   {
     std::cerr << "Error: matrix is the zero matrix!" << std::endl;
-    return SCIP_ERROR;
+    return EXIT_FAILURE;
   }
 
-  double scalingFactor = 1.0 / maxEntry;
-  cpm::Core* core = new cpm::Core(new cpm::SolverSoPlex());
-
-  // Variables
-
-  for (std::size_t i = 0; i < slackmatrix.nonzeros.size(); ++i)
+  if (server)
   {
-    std::stringstream ss;
-    ss << "nonzero#" << i << "#" << slackmatrix.nonzeros[i].row << "#" << slackmatrix.nonzeros[i].column;
-    core->addVariable(ss.str(), scalingFactor * slackmatrix.nonzeros[i].slack, -std::numeric_limits<double>::infinity(), 1.0);
+    try
+    {
+      BoundServer boundServer(slackmatrix, options);
+      if (serverSocket.empty())
+        boundServer.serve(std::cin, std::cout);
+      else
+        boundServer.serveSocket(serverSocket);
+    }
+    catch (std::exception& e)
+    {
+      std::cerr << "Error: " << e.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
   }
 
-  // Oracles
+  // The submatrix search runs alongside the LP of the whole matrix until the latter is solved.
 
-  MaximumWeightRectangleEnumOracle* enumOracle = new MaximumWeightRectangleEnumOracle(slackmatrix, 2);
-  core->addOracle(enumOracle);
-  
-  MaximumWeightRectangleIPOracle* heuristicSCIPOracle = new MaximumWeightRectangleIPOracle(slackmatrix, 1);
-  heuristicSCIPOracle->setIntParam("limits/bestsol", 2);
-//   core->addOracle(heuristicSCIPOracle);
-  
-  MaximumWeightRectangleIPOracle* exactSCIPOracle = new MaximumWeightRectangleIPOracle(slackmatrix, -1);
-  core->addOracle(exactSCIPOracle);
+  std::atomic<bool> stopSearch(false);
+  std::mutex outputMutex;
+  std::string searchError;
+  double searchBound = 0.0;
+  std::thread searchThread;
+  if (submatrixSearch)
+  {
+    searchOptions.numThreads = std::max<std::size_t>(options.numThreads, 2) - 1;
+    searchThread = std::thread([&]()
+      {
+        try
+        {
+          searchBound = searchSubmatrixBounds(slackmatrix, options, searchOptions, [&outputMutex](const SubmatrixBound& improvement)
+            {
+              std::lock_guard<std::mutex> lock(outputMutex);
+              std::cout << improvement.time << ": Submatrix bound " << improvement.bound << " after " << improvement.numSolved
+                << " submatrix LPs." << std::endl;
+            }, &stopSearch);
+        }
+        catch (std::exception& e)
+        {
+          searchError = e.what();
+        }
+      });
+  }
 
-  // Run
-  
-  core->run();
+  BoundResult result;
+  try
+  {
+    result = computeBound(slackmatrix, options);
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "Error: " << e.what() << std::endl;
+    stopSearch = true;
+    if (searchThread.joinable())
+      searchThread.join();
+    return EXIT_FAILURE;
+  }
+  stopSearch = true;
+  if (searchThread.joinable())
+    searchThread.join();
+  if (!searchError.empty())
+  {
+    std::cerr << "Error in submatrix search: " << searchError << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (submatrixSearch)
+    std::cout << "Best submatrix bound: " << searchBound << "." << std::endl;
 
-  delete exactSCIPOracle;
-  delete heuristicSCIPOracle;
-  delete enumOracle;
-  delete core;
+  if (result.statistics.numComponents > 1)
+    std::cout << "Solved " << result.statistics.numComponents << " connected components." << std::endl;
+  std::cout << "Primal bound: " << result.primalBound << ", dual bound: " << result.dualBound << "." << std::endl;
+  if (result.unproven)
+    std::cout << "Warning: Oracles exhausted their time budgets, so the bounds are not proven to be optimal." << std::endl;
 }
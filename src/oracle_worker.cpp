@@ -0,0 +1,16 @@
+#include <iostream>
+#include <cstdlib>
+
+#include "process_oracle.h"
+
+int main(int argc, char** argv)
+{
+  if (argc != 3)
+  {
+    std::cerr << "Usage: " << argv[0] << " SOCKET-DESCRIPTOR MEMORY-DESCRIPTOR\n";
+    std::cerr << "Worker process of ProcessPoolOracle, not meant to be started manually." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return runOracleWorker(atoi(argv[1]), atoi(argv[2]));
+}
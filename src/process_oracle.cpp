@@ -0,0 +1,452 @@
+#include "process_oracle.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "scip_oracle.h"
+
+/* Every message starts with a 64-bit word. The initialization message carries this magic number, the configuration, the nonzeros
+ * and the oracle name. A separation command carries the interval of first rows to solve for. Replies start with 0 on success and
+ * with the length of an error message otherwise. */
+
+static const std::uint64_t PROTOCOL_MAGIC = 0x31524b524f574e52ULL;
+static const std::uint64_t COMMAND_SEPARATE = 1;
+
+static void writeAll(int socket, const void* data, std::size_t size)
+{
+  const char* bytes = static_cast<const char*>(data);
+  while (size > 0)
+  {
+    ssize_t written = send(socket, bytes, size, MSG_NOSIGNAL);
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0)
+      throw std::runtime_error(std::string("ProcessPoolOracle: Cannot write to socket: ") + strerror(errno));
+    bytes += written;
+    size -= written;
+  }
+}
+
+/* Returns false if the peer closed the socket before the first byte. */
+
+static bool readAll(int socket, void* data, std::size_t size)
+{
+  char* bytes = static_cast<char*>(data);
+  bool first = true;
+  while (size > 0)
+  {
+    ssize_t received = read(socket, bytes, size);
+    if (received < 0 && errno == EINTR)
+      continue;
+    if (received == 0 && first)
+      return false;
+    if (received <= 0)
+      throw std::runtime_error("ProcessPoolOracle: Connection closed unexpectedly.");
+    bytes += received;
+    size -= received;
+    first = false;
+  }
+  return true;
+}
+
+static void readReply(int socket)
+{
+  std::uint64_t status;
+  if (!readAll(socket, &status, sizeof(status)))
+    throw std::runtime_error("ProcessPoolOracle: Worker terminated.");
+  if (status == 0)
+    return;
+
+  std::string message(status, ' ');
+  readAll(socket, &message[0], status);
+  throw std::runtime_error("ProcessPoolOracle: Worker failed: " + message);
+}
+
+static void writeError(int socket, const std::string& message)
+{
+  std::uint64_t length = std::max<std::size_t>(message.size(), 1);
+  writeAll(socket, &length, sizeof(length));
+  writeAll(socket, message.empty() ? "?" : message.data(), length);
+}
+
+ProcessPoolOracle::ProcessPoolOracle(const Slackmatrix& slackmatrix, int priority, const std::string& oracleName,
+  const BoundOptions& options, std::size_t numWorkers, const std::string& workerExecutable)
+  : SeparationOracle(slackmatrix.nonzeros.size(), priority), _slackmatrix(slackmatrix), _memoryDescriptor(-1), _points(NULL)
+{
+  if (oracleName != "exact" && oracleName != "heuristic")
+    throw std::runtime_error("ProcessPoolOracle: Oracle <" + oracleName + "> cannot run in worker processes.");
+  numWorkers = std::max<std::size_t>(std::min(numWorkers, slackmatrix.numRows), 1);
+
+  std::size_t bufferSize = std::max<std::size_t>(slackmatrix.nonzeros.size(), 1) * sizeof(double);
+  _memoryDescriptor = memfd_create("cpm-points", MFD_CLOEXEC);
+  if (_memoryDescriptor < 0 || ftruncate(_memoryDescriptor, bufferSize) != 0)
+    throw std::runtime_error(std::string("ProcessPoolOracle: Cannot create shared memory: ") + strerror(errno));
+  void* mapping = mmap(NULL, bufferSize, PROT_READ | PROT_WRITE, MAP_SHARED, _memoryDescriptor, 0);
+  if (mapping == MAP_FAILED)
+  {
+    close(_memoryDescriptor);
+    throw std::runtime_error(std::string("ProcessPoolOracle: Cannot map shared memory: ") + strerror(errno));
+  }
+  _points = static_cast<double*>(mapping);
+  partitionFirstRows(slackmatrix.numRows, 8 * numWorkers, _blockBoundaries);
+
+  // The matrix and configuration sent to every worker.
+
+  std::vector<std::uint64_t> message;
+  message.push_back(PROTOCOL_MAGIC);
+  message.push_back(slackmatrix.numRows);
+  message.push_back(slackmatrix.numColumns);
+  message.push_back(slackmatrix.nonzeros.size());
+  message.push_back(options.subsetSize);
+  message.push_back(options.subsetExactLimit);
+  message.push_back(static_cast<std::int64_t>(options.cutLimit));
+  message.push_back(options.escalate ? 1 : 0);
+  message.push_back(options.restrictSupport ? 1 : 0);
+  message.push_back(oracleName.size());
+  for (std::size_t i = 0; i < slackmatrix.nonzeros.size(); ++i)
+  {
+    message.push_back(slackmatrix.nonzeros[i].row);
+    message.push_back(slackmatrix.nonzeros[i].column);
+    message.push_back(slackmatrix.nonzeros[i].slack);
+  }
+
+  try
+  {
+    for (std::size_t w = 0; w < numWorkers; ++w)
+    {
+      int sockets[2];
+      if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0)
+        throw std::runtime_error(std::string("ProcessPoolOracle: Cannot create socket: ") + strerror(errno));
+
+      // Arguments are prepared before forking since the child may only call async-signal-safe functions until exec.
+
+      std::string socketArgument = std::to_string(sockets[1]);
+      std::string memoryArgument = std::to_string(_memoryDescriptor);
+      char* arguments[] = { const_cast<char*>(workerExecutable.c_str()), const_cast<char*>(socketArgument.c_str()),
+        const_cast<char*>(memoryArgument.c_str()), NULL };
+      pid_t pid = fork();
+      if (pid == 0)
+      {
+        fcntl(sockets[1], F_SETFD, 0);
+        fcntl(_memoryDescriptor, F_SETFD, 0);
+        execv(workerExecutable.c_str(), arguments);
+        _exit(127);
+      }
+      close(sockets[1]);
+      if (pid < 0)
+      {
+        close(sockets[0]);
+        throw std::runtime_error(std::string("ProcessPoolOracle: Cannot fork: ") + strerror(errno));
+      }
+      _workers.push_back(pid);
+      _sockets.push_back(sockets[0]);
+
+      writeAll(sockets[0], message.data(), message.size() * sizeof(std::uint64_t));
+      writeAll(sockets[0], oracleName.data(), oracleName.size());
+    }
+    for (std::size_t w = 0; w < numWorkers; ++w)
+      readReply(_sockets[w]);
+  }
+  catch (...)
+  {
+    shutdown();
+    throw;
+  }
+}
+
+ProcessPoolOracle::~ProcessPoolOracle()
+{
+  shutdown();
+}
+
+void ProcessPoolOracle::shutdown()
+{
+  // Workers exit as soon as their socket is closed.
+
+  for (std::size_t w = 0; w < _sockets.size(); ++w)
+    close(_sockets[w]);
+  for (std::size_t w = 0; w < _workers.size(); ++w)
+  {
+    int status;
+    while (waitpid(_workers[w], &status, 0) < 0 && errno == EINTR);
+  }
+  _sockets.clear();
+  _workers.clear();
+  if (_points != NULL)
+    munmap(_points, std::max<std::size_t>(_slackmatrix.nonzeros.size(), 1) * sizeof(double));
+  _points = NULL;
+  if (_memoryDescriptor >= 0)
+    close(_memoryDescriptor);
+  _memoryDescriptor = -1;
+}
+
+void ProcessPoolOracle::separate(bool separatePoint, const double* vector, std::vector<double>& lhs, std::vector<double>& rhs,
+  std::vector<std::size_t>& begin, std::vector<std::size_t>& indices, std::vector<double>& values, double& violationLowerBound,
+  double& violationUpperBound)
+{
+  _rectangles.clear();
+  separateRectangles(vector, _rectangles, violationLowerBound, violationUpperBound);
+  _slackmatrix.appendInequalities(_rectangles, lhs, rhs, begin, indices, values);
+}
+
+bool ProcessPoolOracle::separateRectangles(const double* vector, std::vector<cpm::Rectangle>& rectangles,
+  double& violationLowerBound, double& violationUpperBound)
+{
+  std::copy(vector, vector + ambientDimension(), _points);
+
+  // Blocks of first rows are handed out to the workers as they become idle, and no more once interrupted.
+
+  std::size_t numBlocks = _blockBoundaries.size() - 1;
+  std::size_t nextBlock = 0;
+  std::size_t numSolvedBlocks = 0;
+  std::vector<struct pollfd> busy;
+  for (std::size_t w = 0; w < _sockets.size() && nextBlock < numBlocks; ++w, ++nextBlock)
+  {
+    sendBlock(_sockets[w], nextBlock);
+    struct pollfd descriptor = { _sockets[w], POLLIN, 0 };
+    busy.push_back(descriptor);
+  }
+
+  // The blocks cover all rectangles, so the maximum of their upper bounds is exact, unless some were skipped by an interrupt.
+
+  double maxUpperBound = -std::numeric_limits<double>::infinity();
+  while (!busy.empty())
+  {
+    if (poll(busy.data(), busy.size(), -1) < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      throw std::runtime_error(std::string("ProcessPoolOracle: Cannot poll sockets: ") + strerror(errno));
+    }
+    for (std::size_t b = 0; b < busy.size(); )
+    {
+      if (busy[b].revents == 0)
+      {
+        ++b;
+        continue;
+      }
+
+      int socket = busy[b].fd;
+      readReply(socket);
+      double bounds[2];
+      std::uint64_t numRectangles;
+      readAll(socket, bounds, sizeof(bounds));
+      readAll(socket, &numRectangles, sizeof(numRectangles));
+      for (std::uint64_t r = 0; r < numRectangles; ++r)
+      {
+        std::uint64_t sizes[2];
+        readAll(socket, sizes, sizeof(sizes));
+        rectangles.push_back(cpm::Rectangle());
+        rectangles.back().rows.resize(sizes[0]);
+        rectangles.back().columns.resize(sizes[1]);
+        readAll(socket, rectangles.back().rows.data(), sizes[0] * sizeof(std::uint32_t));
+        readAll(socket, rectangles.back().columns.data(), sizes[1] * sizeof(std::uint32_t));
+      }
+      violationLowerBound = std::max(violationLowerBound, bounds[0]);
+      maxUpperBound = std::max(maxUpperBound, bounds[1]);
+      ++numSolvedBlocks;
+
+      busy[b].revents = 0;
+      if (nextBlock < numBlocks && !interruptRequested())
+      {
+        sendBlock(socket, nextBlock++);
+        ++b;
+      }
+      else
+      {
+        busy[b] = busy.back();
+        busy.pop_back();
+      }
+    }
+  }
+  if (numSolvedBlocks < numBlocks)
+    maxUpperBound = std::numeric_limits<double>::max();
+  violationUpperBound = maxUpperBound;
+
+  _feasiblePoint.clear();
+  if (maxUpperBound < 1000 && maxUpperBound > -1.0)
+  {
+    _feasiblePoint.resize(ambientDimension());
+    for (std::size_t v = 0; v < ambientDimension(); ++v)
+      _feasiblePoint[v] = vector[v] / (1.0 + maxUpperBound);
+  }
+
+  return true;
+}
+
+void ProcessPoolOracle::sendBlock(int socket, std::size_t block)
+{
+  std::uint64_t command[3] = { COMMAND_SEPARATE, _blockBoundaries[block], _blockBoundaries[block + 1] };
+  writeAll(socket, command, sizeof(command));
+}
+
+void ProcessPoolOracle::interrupt()
+{
+  cpm::SeparationOracle::interrupt();
+  for (std::size_t w = 0; w < _workers.size(); ++w)
+    kill(_workers[w], SIGUSR1);
+}
+
+void ProcessPoolOracle::getFeasiblePointProperties(bool& scaledDown, bool& scaledUp, std::vector<std::size_t>& modifiableVariables) const
+{
+  cpm::SeparationOracle::getFeasiblePointProperties(scaledDown, scaledUp, modifiableVariables);
+  scaledDown = true;
+}
+
+std::size_t ProcessPoolOracle::numFeasiblePoints() const
+{
+  return _feasiblePoint.empty() ? 0 : 1;
+}
+
+void ProcessPoolOracle::getFeasiblePoint(std::size_t id, std::vector<double>& point) const
+{
+  if (id >= numFeasiblePoints())
+    throw std::runtime_error("Invalid index while querying a feasible point.");
+  point = _feasiblePoint;
+}
+
+std::string ProcessPoolOracle::defaultWorkerExecutable()
+{
+  char path[4096];
+  ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+  if (length <= 0)
+    return "oracle-worker";
+  std::string executable(path, length);
+  std::size_t slash = executable.rfind('/');
+  return executable.substr(0, slash + 1) + "oracle-worker";
+}
+
+/* The oracle of a worker process, which is interrupted by SIGUSR1. */
+
+static cpm::SeparationOracle* workerOracle = NULL;
+
+static void handleInterrupt(int)
+{
+  if (workerOracle != NULL)
+    workerOracle->interrupt();
+}
+
+int runOracleWorker(int socket, int memoryDescriptor)
+{
+  std::uint64_t header[10];
+  if (!readAll(socket, header, sizeof(header)))
+    return 0;
+  if (header[0] != PROTOCOL_MAGIC)
+  {
+    writeError(socket, "Protocol mismatch.");
+    return 1;
+  }
+
+  std::unique_ptr<Slackmatrix> slackmatrix;
+  std::unique_ptr<cpm::SeparationOracle> oracle;
+  const double* point = NULL;
+  std::size_t bufferSize = std::max<std::size_t>(header[3], 1) * sizeof(double);
+  try
+  {
+    std::vector<std::uint64_t> triples(3 * header[3]);
+    readAll(socket, triples.data(), triples.size() * sizeof(std::uint64_t));
+    std::string name(header[9], ' ');
+    readAll(socket, &name[0], name.size());
+    std::vector<Slackmatrix::Nonzero> nonzeros(header[3]);
+    for (std::size_t i = 0; i < nonzeros.size(); ++i)
+    {
+      nonzeros[i].row = triples[3 * i];
+      nonzeros[i].column = triples[3 * i + 1];
+      nonzeros[i].slack = triples[3 * i + 2];
+    }
+    slackmatrix.reset(new Slackmatrix(header[1], header[2], nonzeros));
+
+    BoundOptions options;
+    options.subsetSize = header[4];
+    options.subsetExactLimit = header[5];
+    options.cutLimit = static_cast<int>(static_cast<std::int64_t>(header[6]));
+    options.escalate = header[7] != 0;
+    options.restrictSupport = header[8] != 0;
+    oracle.reset(createOracle(name, *slackmatrix, options));
+    MaximumWeightRectangleIPOracle* scipOracle = dynamic_cast<MaximumWeightRectangleIPOracle*>(oracle.get());
+    if (scipOracle == NULL)
+      throw std::runtime_error("Oracle <" + name + "> is not a SCIP oracle.");
+
+    void* mapping = mmap(NULL, bufferSize, PROT_READ, MAP_SHARED, memoryDescriptor, 0);
+    if (mapping == MAP_FAILED)
+      throw std::runtime_error(std::string("Cannot map shared memory: ") + strerror(errno));
+    point = static_cast<const double*>(mapping);
+  }
+  catch (std::exception& e)
+  {
+    writeError(socket, e.what());
+    return 1;
+  }
+  std::uint64_t status = 0;
+  writeAll(socket, &status, sizeof(status));
+
+  workerOracle = oracle.get();
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = handleInterrupt;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  sigaction(SIGUSR1, &action, NULL);
+
+  // Serve requests until the socket is closed.
+
+  MaximumWeightRectangleIPOracle* scipOracle = static_cast<MaximumWeightRectangleIPOracle*>(oracle.get());
+  std::vector<cpm::Rectangle> rectangles;
+  std::vector<std::uint64_t> reply;
+  std::uint64_t command[3];
+  while (true)
+  {
+    // A new generation starts before the command is awaited, so that a signal arriving before the solve still interrupts it. A late
+    // signal for the previous command may cut the next solve short, which only weakens its bounds.
+
+    oracle->beginCall();
+    if (!readAll(socket, command, sizeof(command)))
+      break;
+    if (command[0] != COMMAND_SEPARATE)
+    {
+      writeError(socket, "Unknown command.");
+      continue;
+    }
+
+    double bounds[2] = { 0.0, std::numeric_limits<double>::max() };
+    rectangles.clear();
+    try
+    {
+      scipOracle->setRowRange(command[1], command[2]);
+      oracle->separateRectangles(point, rectangles, bounds[0], bounds[1]);
+    }
+    catch (std::exception& e)
+    {
+      writeError(socket, e.what());
+      continue;
+    }
+
+    std::uint64_t numRectangles = rectangles.size();
+    writeAll(socket, &status, sizeof(status));
+    writeAll(socket, bounds, sizeof(bounds));
+    writeAll(socket, &numRectangles, sizeof(numRectangles));
+    for (std::size_t r = 0; r < rectangles.size(); ++r)
+    {
+      std::uint64_t sizes[2] = { rectangles[r].rows.size(), rectangles[r].columns.size() };
+      writeAll(socket, sizes, sizeof(sizes));
+      writeAll(socket, rectangles[r].rows.data(), sizes[0] * sizeof(std::uint32_t));
+      writeAll(socket, rectangles[r].columns.data(), sizes[1] * sizeof(std::uint32_t));
+    }
+  }
+
+  workerOracle = NULL;
+  munmap(const_cast<double*>(point), bufferSize);
+  return 0;
+}
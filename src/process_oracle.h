@@ -0,0 +1,80 @@
+#ifndef _PROCESS_ORACLE_H_
+#define _PROCESS_ORACLE_H_
+
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <cpm/separation_oracle.h>
+
+#include "bounds.h"
+#include "slackmatrix.h"
+
+/**
+ * Oracle that forwards separation to a pool of worker processes, each owning its own SCIP oracle. Blocks of first rows of the
+ * rectangles, as returned by partitionFirstRows(), are handed out to the workers as they become idle. Points are passed in a shared memory buffer and commands and rectangles over Unix sockets. Workers run the
+ * oracle-worker executable, which receives the matrix and its configuration over the socket as well, so that only the point buffer
+ * relies on sharing a machine.
+ */
+
+class ProcessPoolOracle : public cpm::SeparationOracle
+{
+public:
+  /**
+   * Starts numWorkers processes of the given executable, each running the oracle of the given name, which must be a SCIP oracle.
+   */
+
+  ProcessPoolOracle(const Slackmatrix& slackmatrix, int priority, const std::string& oracleName, const BoundOptions& options,
+    std::size_t numWorkers, const std::string& workerExecutable);
+
+  virtual ~ProcessPoolOracle();
+
+  virtual void separate(bool separatePoint, const double* vector, std::vector<double>& lhs, std::vector<double>& rhs,
+    std::vector<std::size_t>& begin, std::vector<std::size_t>& indices, std::vector<double>& values, double& violationLowerBound,
+    double& violationUpperBound);
+
+  virtual bool separateRectangles(const double* vector, std::vector<cpm::Rectangle>& rectangles, double& violationLowerBound,
+    double& violationUpperBound);
+
+  /**
+   * Signals all workers to stop their current solve.
+   */
+
+  virtual void interrupt();
+
+  virtual void getFeasiblePointProperties(bool& scaledDown, bool& scaledUp, std::vector<std::size_t>& modifiableVariables) const;
+
+  virtual std::size_t numFeasiblePoints() const;
+
+  virtual void getFeasiblePoint(std::size_t id, std::vector<double>& point) const;
+
+  /**
+   * Returns the path of the oracle-worker executable next to the running executable.
+   */
+
+  static std::string defaultWorkerExecutable();
+
+protected:
+  void shutdown();
+
+  void sendBlock(int socket, std::size_t block);
+
+  const Slackmatrix& _slackmatrix;
+  std::vector<pid_t> _workers;
+  std::vector<int> _sockets;
+  int _memoryDescriptor;
+  double* _points;
+  std::vector<std::size_t> _blockBoundaries;
+  std::vector<cpm::Rectangle> _rectangles;
+  std::vector<double> _feasiblePoint;
+};
+
+/**
+ * Serves separation requests of a ProcessPoolOracle on the given socket and shared memory descriptor until the socket is closed.
+ * Returns the exit code of the worker process.
+ */
+
+int runOracleWorker(int socket, int memoryDescriptor);
+
+#endif /* _PROCESS_ORACLE_H_ */
@@ -0,0 +1,236 @@
+#include "rectangle_library.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* The file starts with this magic number, followed by records of two 32-bit counts and the 64-bit row and column identifiers. */
+
+static const std::uint64_t LIBRARY_MAGIC = 0x3154434552424e52ULL;
+
+RectangleLibrary::RectangleLibrary(const std::string& fileName)
+  : _fileName(fileName), _fileDescriptor(-1), _mapping(NULL), _mappingSize(0)
+{
+  _fileDescriptor = open(fileName.c_str(), O_RDWR | O_CREAT, 0644);
+  if (_fileDescriptor < 0)
+    throw std::runtime_error("RectangleLibrary: Cannot open <" + fileName + ">: " + strerror(errno));
+
+  struct stat status;
+  if (fstat(_fileDescriptor, &status) != 0)
+  {
+    close(_fileDescriptor);
+    throw std::runtime_error("RectangleLibrary: Cannot stat <" + fileName + ">.");
+  }
+  std::size_t size = status.st_size;
+  if (size == 0)
+  {
+    if (write(_fileDescriptor, &LIBRARY_MAGIC, sizeof(LIBRARY_MAGIC)) != (ssize_t) sizeof(LIBRARY_MAGIC))
+    {
+      close(_fileDescriptor);
+      throw std::runtime_error("RectangleLibrary: Cannot write to <" + fileName + ">.");
+    }
+    return;
+  }
+
+  _mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, _fileDescriptor, 0);
+  if (_mapping == MAP_FAILED)
+  {
+    close(_fileDescriptor);
+    throw std::runtime_error("RectangleLibrary: Cannot map <" + fileName + ">.");
+  }
+  _mappingSize = size;
+  const char* data = static_cast<const char*>(_mapping);
+  if (size < sizeof(LIBRARY_MAGIC) || *reinterpret_cast<const std::uint64_t*>(data) != LIBRARY_MAGIC)
+  {
+    munmap(_mapping, _mappingSize);
+    close(_fileDescriptor);
+    throw std::runtime_error("RectangleLibrary: <" + fileName + "> is not a rectangle library.");
+  }
+
+  std::size_t offset = sizeof(LIBRARY_MAGIC);
+  std::vector<std::uint64_t> rowIdentifiers, columnIdentifiers;
+  while (offset + 2 * sizeof(std::uint32_t) <= size)
+  {
+    Record record;
+    record.numRows = reinterpret_cast<const std::uint32_t*>(data + offset)[0];
+    record.numColumns = reinterpret_cast<const std::uint32_t*>(data + offset)[1];
+    std::size_t recordSize = 2 * sizeof(std::uint32_t) + sizeof(std::uint64_t) * (std::size_t(record.numRows) + record.numColumns);
+    if (offset + recordSize > size)
+      break;
+
+    record.rowIdentifiers = reinterpret_cast<const std::uint64_t*>(data + offset + 2 * sizeof(std::uint32_t));
+    record.columnIdentifiers = record.rowIdentifiers + record.numRows;
+    _records.push_back(record);
+    rowIdentifiers.assign(record.rowIdentifiers, record.rowIdentifiers + record.numRows);
+    columnIdentifiers.assign(record.columnIdentifiers, record.columnIdentifiers + record.numColumns);
+    _recordsByHash.insert(std::make_pair(hash(rowIdentifiers, columnIdentifiers), record));
+    offset += recordSize;
+  }
+
+  // Drop a record that was only partially written, e.g., due to an interrupted run.
+
+  if (offset < size && ftruncate(_fileDescriptor, offset) != 0)
+  {
+    munmap(_mapping, _mappingSize);
+    close(_fileDescriptor);
+    throw std::runtime_error("RectangleLibrary: Cannot truncate <" + fileName + ">.");
+  }
+}
+
+RectangleLibrary::~RectangleLibrary()
+{
+  if (_mapping != NULL)
+    munmap(_mapping, _mappingSize);
+  close(_fileDescriptor);
+}
+
+std::uint64_t RectangleLibrary::hash(const std::vector<std::uint64_t>& rowIdentifiers,
+  const std::vector<std::uint64_t>& columnIdentifiers)
+{
+  std::uint64_t result = 14695981039346656037ULL;
+  result = (result ^ rowIdentifiers.size()) * 1099511628211ULL;
+  for (std::size_t i = 0; i < rowIdentifiers.size(); ++i)
+    result = (result ^ rowIdentifiers[i]) * 1099511628211ULL;
+  result = (result ^ columnIdentifiers.size()) * 1099511628211ULL;
+  for (std::size_t i = 0; i < columnIdentifiers.size(); ++i)
+    result = (result ^ columnIdentifiers[i]) * 1099511628211ULL;
+  return result;
+}
+
+bool RectangleLibrary::equals(const Record& record, const std::vector<std::uint64_t>& rowIdentifiers,
+  const std::vector<std::uint64_t>& columnIdentifiers)
+{
+  return record.numRows == rowIdentifiers.size() && record.numColumns == columnIdentifiers.size()
+    && std::equal(rowIdentifiers.begin(), rowIdentifiers.end(), record.rowIdentifiers)
+    && std::equal(columnIdentifiers.begin(), columnIdentifiers.end(), record.columnIdentifiers);
+}
+
+void RectangleLibrary::findValid(const Slackmatrix& slackmatrix, std::vector<cpm::Rectangle>& rectangles) const
+{
+  std::unordered_map<std::uint64_t, std::size_t> rowOfIdentifier, columnOfIdentifier;
+  for (std::size_t row = 0; row < slackmatrix.numRows; ++row)
+    rowOfIdentifier[slackmatrix.rowIdentifiers[row]] = row;
+  for (std::size_t column = 0; column < slackmatrix.numColumns; ++column)
+    columnOfIdentifier[slackmatrix.columnIdentifiers[column]] = column;
+
+  rectangles.clear();
+  cpm::Rectangle rectangle;
+  for (std::size_t i = 0; i < _records.size(); ++i)
+  {
+    const Record& record = _records[i];
+    rectangle.rows.clear();
+    for (std::uint32_t r = 0; r < record.numRows; ++r)
+    {
+      std::unordered_map<std::uint64_t, std::size_t>::const_iterator iter = rowOfIdentifier.find(record.rowIdentifiers[r]);
+      if (iter != rowOfIdentifier.end())
+        rectangle.rows.push_back(iter->second);
+    }
+    rectangle.columns.clear();
+    for (std::uint32_t c = 0; c < record.numColumns; ++c)
+    {
+      std::unordered_map<std::uint64_t, std::size_t>::const_iterator iter = columnOfIdentifier.find(record.columnIdentifiers[c]);
+      if (iter != columnOfIdentifier.end())
+        rectangle.columns.push_back(iter->second);
+    }
+    if (rectangle.rows.empty() || rectangle.columns.empty())
+      continue;
+
+    bool valid = true;
+    for (std::size_t r = 0; r < rectangle.rows.size() && valid; ++r)
+    {
+      for (std::size_t c = 0; c < rectangle.columns.size() && valid; ++c)
+        valid = slackmatrix.denseIndices[rectangle.rows[r]][rectangle.columns[c]] != std::numeric_limits<std::size_t>::max();
+    }
+    if (valid)
+    {
+      rectangle.normalize();
+      rectangles.push_back(rectangle);
+    }
+  }
+}
+
+void RectangleLibrary::append(const Slackmatrix& slackmatrix, const std::vector<std::size_t>& nonzeros)
+{
+  std::vector<std::uint64_t> rowIdentifiers, columnIdentifiers;
+  for (std::size_t i = 0; i < nonzeros.size(); ++i)
+  {
+    rowIdentifiers.push_back(slackmatrix.rowIdentifiers[slackmatrix.nonzeros[nonzeros[i]].row]);
+    columnIdentifiers.push_back(slackmatrix.columnIdentifiers[slackmatrix.nonzeros[nonzeros[i]].column]);
+  }
+  append(rowIdentifiers, columnIdentifiers);
+}
+
+void RectangleLibrary::append(const Slackmatrix& slackmatrix, const cpm::Rectangle& rectangle)
+{
+  std::vector<std::uint64_t> rowIdentifiers(rectangle.rows.size());
+  for (std::size_t r = 0; r < rectangle.rows.size(); ++r)
+    rowIdentifiers[r] = slackmatrix.rowIdentifiers[rectangle.rows[r]];
+  std::vector<std::uint64_t> columnIdentifiers(rectangle.columns.size());
+  for (std::size_t c = 0; c < rectangle.columns.size(); ++c)
+    columnIdentifiers[c] = slackmatrix.columnIdentifiers[rectangle.columns[c]];
+  append(rowIdentifiers, columnIdentifiers);
+}
+
+void RectangleLibrary::append(std::vector<std::uint64_t>& rowIdentifiers, std::vector<std::uint64_t>& columnIdentifiers)
+{
+  std::sort(rowIdentifiers.begin(), rowIdentifiers.end());
+  rowIdentifiers.erase(std::unique(rowIdentifiers.begin(), rowIdentifiers.end()), rowIdentifiers.end());
+  std::sort(columnIdentifiers.begin(), columnIdentifiers.end());
+  columnIdentifiers.erase(std::unique(columnIdentifiers.begin(), columnIdentifiers.end()), columnIdentifiers.end());
+  if (rowIdentifiers.empty() || columnIdentifiers.empty())
+    return;
+
+  std::vector<std::uint64_t> buffer(1 + rowIdentifiers.size() + columnIdentifiers.size());
+  std::uint32_t* counts = reinterpret_cast<std::uint32_t*>(&buffer[0]);
+  counts[0] = rowIdentifiers.size();
+  counts[1] = columnIdentifiers.size();
+  std::copy(rowIdentifiers.begin(), rowIdentifiers.end(), buffer.begin() + 1);
+  std::copy(columnIdentifiers.begin(), columnIdentifiers.end(), buffer.begin() + 1 + rowIdentifiers.size());
+
+  // Equal hashes need not mean equal rectangles, so candidates are compared in full.
+
+  std::uint64_t key = hash(rowIdentifiers, columnIdentifiers);
+  std::lock_guard<std::mutex> lock(_mutex);
+  typedef std::unordered_multimap<std::uint64_t, Record>::const_iterator Iterator;
+  std::pair<Iterator, Iterator> candidates = _recordsByHash.equal_range(key);
+  for (Iterator iter = candidates.first; iter != candidates.second; ++iter)
+  {
+    if (equals(iter->second, rowIdentifiers, columnIdentifiers))
+      return;
+  }
+
+  // Records are written in one piece at the end of the file.
+
+  if (lseek(_fileDescriptor, 0, SEEK_END) < 0)
+    throw std::runtime_error("RectangleLibrary: Cannot seek in <" + _fileName + ">.");
+  const char* data = reinterpret_cast<const char*>(&buffer[0]);
+  std::size_t remaining = buffer.size() * sizeof(std::uint64_t);
+  while (remaining > 0)
+  {
+    ssize_t written = write(_fileDescriptor, data, remaining);
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0)
+      throw std::runtime_error("RectangleLibrary: Cannot write to <" + _fileName + ">.");
+    data += written;
+    remaining -= written;
+  }
+
+  // The buffer keeps its storage when moved, so the record may point into it.
+
+  _appendedRecords.push_back(std::move(buffer));
+  Record record;
+  record.numRows = rowIdentifiers.size();
+  record.numColumns = columnIdentifiers.size();
+  record.rowIdentifiers = &_appendedRecords.back()[1];
+  record.columnIdentifiers = record.rowIdentifiers + record.numRows;
+  _recordsByHash.insert(std::make_pair(key, record));
+}
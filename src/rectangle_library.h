@@ -0,0 +1,75 @@
+#ifndef _RECTANGLE_LIBRARY_H_
+#define _RECTANGLE_LIBRARY_H_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "slackmatrix.h"
+
+/**
+ * File of rectangles stored as sets of row and column identifiers, which is memory-mapped for reading and extended by appending.
+ * A rectangle of one matrix remains a valid cut for every matrix in which the identified rows and columns form an all-nonzero
+ * submatrix. Reading is thread-safe, and so is appending.
+ */
+
+class RectangleLibrary
+{
+public:
+  RectangleLibrary(const std::string& fileName);
+
+  ~RectangleLibrary();
+
+  inline std::size_t numRectangles() const
+  {
+    return _records.size();
+  }
+
+  /**
+   * Computes the stored rectangles that are valid for the given matrix, in terms of its rows and columns. Rows and columns unknown
+   * to the matrix are dropped, and rectangles containing a zero entry are skipped.
+   */
+
+  void findValid(const Slackmatrix& slackmatrix, std::vector<cpm::Rectangle>& rectangles) const;
+
+  /**
+   * Appends the rectangle spanned by the rows and columns of the given nonzeros unless it is already stored.
+   */
+
+  void append(const Slackmatrix& slackmatrix, const std::vector<std::size_t>& nonzeros);
+
+  /**
+   * Appends the given rectangle of the matrix unless it is already stored.
+   */
+
+  void append(const Slackmatrix& slackmatrix, const cpm::Rectangle& rectangle);
+
+protected:
+  struct Record
+  {
+    const std::uint64_t* rowIdentifiers;
+    const std::uint64_t* columnIdentifiers;
+    std::uint32_t numRows;
+    std::uint32_t numColumns;
+  };
+
+  void append(std::vector<std::uint64_t>& rowIdentifiers, std::vector<std::uint64_t>& columnIdentifiers);
+
+  static std::uint64_t hash(const std::vector<std::uint64_t>& rowIdentifiers, const std::vector<std::uint64_t>& columnIdentifiers);
+
+  static bool equals(const Record& record, const std::vector<std::uint64_t>& rowIdentifiers,
+    const std::vector<std::uint64_t>& columnIdentifiers);
+
+  std::string _fileName;
+  int _fileDescriptor;
+  void* _mapping;
+  std::size_t _mappingSize;
+  std::vector<Record> _records;
+  std::unordered_multimap<std::uint64_t, Record> _recordsByHash; /**< Stored and appended records, grouped by hash. */
+  std::vector<std::vector<std::uint64_t> > _appendedRecords; /**< Copies of the records appended by this instance. */
+  std::mutex _mutex;
+};
+
+#endif /* _RECTANGLE_LIBRARY_H_ */
@@ -0,0 +1,161 @@
+#include "reordering.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+/* Breadth-first search from start that visits neighbors by increasing degree. Appends the visited vertices to order and returns the
+ * first vertex of the last level. */
+
+static std::size_t cuthillMcKee(const std::vector<std::vector<std::size_t> >& adjacency, std::size_t start, std::vector<bool>& visited,
+  std::vector<std::size_t>& order)
+{
+  std::size_t levelBegin = order.size();
+  std::size_t lastLevelBegin = levelBegin;
+  visited[start] = true;
+  order.push_back(start);
+  std::vector<std::size_t> neighbors;
+  while (levelBegin < order.size())
+  {
+    std::size_t levelEnd = order.size();
+    lastLevelBegin = levelBegin;
+    for (std::size_t i = levelBegin; i < levelEnd; ++i)
+    {
+      neighbors.clear();
+      const std::vector<std::size_t>& adjacent = adjacency[order[i]];
+      for (std::size_t j = 0; j < adjacent.size(); ++j)
+      {
+        if (!visited[adjacent[j]])
+        {
+          visited[adjacent[j]] = true;
+          neighbors.push_back(adjacent[j]);
+        }
+      }
+      std::sort(neighbors.begin(), neighbors.end(), [&adjacency](std::size_t a, std::size_t b)
+        {
+          return adjacency[a].size() < adjacency[b].size() || (adjacency[a].size() == adjacency[b].size() && a < b);
+        });
+      order.insert(order.end(), neighbors.begin(), neighbors.end());
+    }
+    levelBegin = levelEnd;
+  }
+
+  std::size_t last = order[lastLevelBegin];
+  for (std::size_t i = lastLevelBegin; i < order.size(); ++i)
+  {
+    if (adjacency[order[i]].size() < adjacency[last].size())
+      last = order[i];
+  }
+  return last;
+}
+
+void computeOrdering(const Slackmatrix& slackmatrix, const std::string& method, std::vector<std::size_t>& rowOrder,
+  std::vector<std::size_t>& columnOrder)
+{
+  std::size_t numRows = slackmatrix.numRows;
+  std::size_t numColumns = slackmatrix.numColumns;
+  rowOrder.clear();
+  columnOrder.clear();
+  if (method == "weight")
+  {
+    std::vector<std::size_t> rowWeights(numRows, 0);
+    std::vector<std::size_t> columnWeights(numColumns, 0);
+    for (std::size_t i = 0; i < slackmatrix.nonzeros.size(); ++i)
+    {
+      rowWeights[slackmatrix.nonzeros[i].row] += slackmatrix.nonzeros[i].slack;
+      columnWeights[slackmatrix.nonzeros[i].column] += slackmatrix.nonzeros[i].slack;
+    }
+    for (std::size_t row = 0; row < numRows; ++row)
+      rowOrder.push_back(row);
+    for (std::size_t column = 0; column < numColumns; ++column)
+      columnOrder.push_back(column);
+    std::stable_sort(rowOrder.begin(), rowOrder.end(), [&rowWeights](std::size_t a, std::size_t b)
+      {
+        return rowWeights[a] > rowWeights[b];
+      });
+    std::stable_sort(columnOrder.begin(), columnOrder.end(), [&columnWeights](std::size_t a, std::size_t b)
+      {
+        return columnWeights[a] > columnWeights[b];
+      });
+  }
+  else if (method == "rcm")
+  {
+    // Bipartite support graph on rows 0, ..., m-1 and columns m, ..., m+n-1.
+
+    std::vector<std::vector<std::size_t> > adjacency(numRows + numColumns);
+    for (std::size_t i = 0; i < slackmatrix.nonzeros.size(); ++i)
+    {
+      adjacency[slackmatrix.nonzeros[i].row].push_back(numRows + slackmatrix.nonzeros[i].column);
+      adjacency[numRows + slackmatrix.nonzeros[i].column].push_back(slackmatrix.nonzeros[i].row);
+    }
+
+    // Each component is started from a vertex of minimum degree in the last level of a search from its minimum-degree vertex, which
+    // approximates a peripheral vertex.
+
+    std::vector<std::size_t> byDegree(adjacency.size());
+    for (std::size_t v = 0; v < byDegree.size(); ++v)
+      byDegree[v] = v;
+    std::stable_sort(byDegree.begin(), byDegree.end(), [&adjacency](std::size_t a, std::size_t b)
+      {
+        return adjacency[a].size() < adjacency[b].size();
+      });
+    std::vector<bool> visited(adjacency.size(), false);
+    std::vector<bool> probed(adjacency.size(), false);
+    std::vector<std::size_t> order;
+    std::vector<std::size_t> probe;
+    for (std::size_t i = 0; i < byDegree.size(); ++i)
+    {
+      if (visited[byDegree[i]])
+        continue;
+
+      probe.clear();
+      std::size_t start = cuthillMcKee(adjacency, byDegree[i], probed, probe);
+      cuthillMcKee(adjacency, start, visited, order);
+    }
+
+    for (std::size_t k = order.size(); k > 0; --k)
+    {
+      if (order[k - 1] < numRows)
+        rowOrder.push_back(order[k - 1]);
+      else
+        columnOrder.push_back(order[k - 1] - numRows);
+    }
+  }
+  else
+    throw std::runtime_error("Unknown ordering <" + method + ">.");
+}
+
+Slackmatrix permuteSlackmatrix(const Slackmatrix& slackmatrix, const std::vector<std::size_t>& rowOrder,
+  const std::vector<std::size_t>& columnOrder, std::vector<std::size_t>& nonzeroOrder)
+{
+  // Walk the new rows and collect their nonzeros by new column.
+
+  const std::size_t none = std::numeric_limits<std::size_t>::max();
+  std::vector<Slackmatrix::Nonzero> nonzeros;
+  nonzeros.reserve(slackmatrix.nonzeros.size());
+  nonzeroOrder.clear();
+  nonzeroOrder.reserve(slackmatrix.nonzeros.size());
+  for (std::size_t r = 0; r < rowOrder.size(); ++r)
+  {
+    const std::vector<std::size_t>& denseRow = slackmatrix.denseIndices[rowOrder[r]];
+    for (std::size_t c = 0; c < columnOrder.size(); ++c)
+    {
+      std::size_t i = denseRow[columnOrder[c]];
+      if (i == none)
+        continue;
+
+      Slackmatrix::Nonzero nonzero = { r, c, slackmatrix.nonzeros[i].slack };
+      nonzeros.push_back(nonzero);
+      nonzeroOrder.push_back(i);
+    }
+  }
+
+  std::vector<std::uint64_t> rowIdentifiers(rowOrder.size());
+  for (std::size_t r = 0; r < rowOrder.size(); ++r)
+    rowIdentifiers[r] = slackmatrix.rowIdentifiers[rowOrder[r]];
+  std::vector<std::uint64_t> columnIdentifiers(columnOrder.size());
+  for (std::size_t c = 0; c < columnOrder.size(); ++c)
+    columnIdentifiers[c] = slackmatrix.columnIdentifiers[columnOrder[c]];
+
+  return Slackmatrix(rowOrder.size(), columnOrder.size(), nonzeros, rowIdentifiers, columnIdentifiers);
+}
@@ -0,0 +1,26 @@
+#ifndef _REORDERING_H_
+#define _REORDERING_H_
+
+#include <string>
+#include <vector>
+
+#include "slackmatrix.h"
+
+/**
+ * Computes orders of the rows and columns, where order[k] is the original index of the k'th row or column. Method "rcm" applies
+ * reverse Cuthill-McKee to the bipartite support graph, which places rows and columns with overlapping supports next to each other.
+ * Method "weight" sorts rows and columns by decreasing total slack, so that searches meet heavy lines first.
+ */
+
+void computeOrdering(const Slackmatrix& slackmatrix, const std::string& method, std::vector<std::size_t>& rowOrder,
+  std::vector<std::size_t>& columnOrder);
+
+/**
+ * Returns the matrix with rows and columns in the given orders and its nonzeros sorted by row and column. The k'th nonzero of the
+ * result is the nonzeroOrder[k]'th nonzero of slackmatrix. Row and column identifiers move with their rows and columns.
+ */
+
+Slackmatrix permuteSlackmatrix(const Slackmatrix& slackmatrix, const std::vector<std::size_t>& rowOrder,
+  const std::vector<std::size_t>& columnOrder, std::vector<std::size_t>& nonzeroOrder);
+
+#endif /* _REORDERING_H_ */
@@ -0,0 +1,203 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <chrono>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "bounds.h"
+#include "separation_trace.h"
+
+void printUsage(const char* program)
+{
+  std::cerr << "Usage: " << program << " [OPTIONS] TRACE-FILE\n";
+  std::cerr << "Feeds the points of a trace recorded with --trace to the given oracles and reports every call.\n";
+  std::cerr << "Options:\n";
+  std::cerr << "  --oracles LIST       Comma-separated oracles among enum, subset, heuristic and exact (default: enum,exact).\n";
+  std::cerr << "  --subset-size K      Maximum subset size of the subset oracle (default: 3).\n";
+  std::cerr << "  --subset-exact N     Let the subset oracle enumerate all subsets if the shorter side has at most N elements (default: 24).\n";
+  std::cerr << "  --oracle-threads N   Number of threads of the subset and exact oracles (default: 1).\n";
+  std::cerr << "  --cut-limit K        Interrupt SCIP oracles once K violated rectangles were found (default: 0 = never).\n";
+  std::cerr << "  --escalate           Let SCIP oracles try node limits 1, 1000 and 100000 before solving exactly.\n";
+  std::cerr << "  --restrict-support   Let SCIP oracles fix rows and columns without positive LP weight and lift the rectangles.\n";
+  std::cerr << "  --first K            Replay only the first K points.\n";
+  std::cerr << "  --threads N          Number of points separated in parallel, each thread with its own oracles (default: 1).\n";
+  std::cerr << std::flush;
+}
+
+struct ReplayCall
+{
+  double time;
+  std::size_t numCuts;
+  double violationLowerBound;
+  double violationUpperBound;
+};
+
+int main(int argc, char** argv)
+{
+  std::string fileName;
+  BoundOptions options;
+  std::string oracleNames = "enum,exact";
+  std::size_t numThreads = 1;
+  std::size_t maxPoints = std::numeric_limits<std::size_t>::max();
+  for (int a = 1; a < argc; ++a)
+  {
+    std::string arg = argv[a];
+    if (arg == "--oracles" && a + 1 < argc)
+      oracleNames = argv[++a];
+    else if (arg == "--subset-size" && a + 1 < argc)
+      options.subsetSize = std::max(1, atoi(argv[++a]));
+    else if (arg == "--subset-exact" && a + 1 < argc)
+      options.subsetExactLimit = std::max(0, atoi(argv[++a]));
+    else if (arg == "--oracle-threads" && a + 1 < argc)
+      options.oracleThreads = std::max(1, atoi(argv[++a]));
+    else if (arg == "--cut-limit" && a + 1 < argc)
+      options.cutLimit = atoi(argv[++a]);
+    else if (arg == "--escalate")
+      options.escalate = true;
+    else if (arg == "--restrict-support")
+      options.restrictSupport = true;
+    else if (arg == "--first" && a + 1 < argc)
+      maxPoints = std::max(0, atoi(argv[++a]));
+    else if (arg == "--threads" && a + 1 < argc)
+      numThreads = std::max(1, atoi(argv[++a]));
+    else if (fileName.empty() && arg.substr(0, 2) != "--")
+      fileName = arg;
+    else
+    {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (fileName.empty())
+  {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  options.oracles.clear();
+  std::stringstream oracleStream(oracleNames);
+  std::string name;
+  while (std::getline(oracleStream, name, ','))
+    options.oracles.push_back(name);
+
+  std::unique_ptr<SeparationTraceReader> trace;
+  try
+  {
+    trace.reset(new SeparationTraceReader(fileName));
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  const Slackmatrix& slackmatrix = trace->slackmatrix();
+  std::size_t numPoints = std::min(trace->numPoints(), maxPoints);
+  std::cout << "Read " << slackmatrix.numRows << "x" << slackmatrix.numColumns << " matrix with " << slackmatrix.nonzeros.size()
+    << " nonzeros and " << trace->numPoints() << " points." << std::endl;
+
+  // Every thread creates its own oracles and fetches the next point until all are done.
+
+  std::size_t numOracles = options.oracles.size();
+  std::vector<ReplayCall> calls(numPoints * numOracles);
+  std::atomic<std::size_t> nextPoint(0);
+  std::exception_ptr exception;
+  std::mutex exceptionMutex;
+  auto worker = [&]()
+  {
+    std::vector<cpm::SeparationOracle*> oracles;
+    try
+    {
+      for (std::size_t o = 0; o < numOracles; ++o)
+        oracles.push_back(createOracle(options.oracles[o], slackmatrix, options));
+
+      std::vector<double> lhs, rhs, values;
+      std::vector<std::size_t> begin, indices;
+      std::vector<cpm::Rectangle> rectangles;
+      for (std::size_t p = nextPoint++; p < numPoints; p = nextPoint++)
+      {
+        const double* point = &trace->point(p)[0];
+        for (std::size_t o = 0; o < numOracles; ++o)
+        {
+          ReplayCall& call = calls[p * numOracles + o];
+          call.violationLowerBound = 0.0;
+          call.violationUpperBound = std::numeric_limits<double>::infinity();
+          lhs.clear();
+          rhs.clear();
+          begin.clear();
+          indices.clear();
+          values.clear();
+          rectangles.clear();
+          std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+          if (!oracles[o]->separateRectangles(point, rectangles, call.violationLowerBound, call.violationUpperBound))
+          {
+            oracles[o]->separate(true, point, lhs, rhs, begin, indices, values, call.violationLowerBound,
+              call.violationUpperBound);
+          }
+          call.time = std::chrono::duration_cast<std::chrono::duration<double> >(std::chrono::steady_clock::now() - timeStart).count();
+          call.numCuts = rectangles.size() + lhs.size();
+        }
+      }
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(exceptionMutex);
+      if (!exception)
+        exception = std::current_exception();
+      nextPoint = numPoints;
+    }
+    for (std::size_t o = 0; o < oracles.size(); ++o)
+      delete oracles[o];
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t t = 1; t < numThreads; ++t)
+    threads.push_back(std::thread(worker));
+  worker();
+  for (std::size_t t = 0; t < threads.size(); ++t)
+    threads[t].join();
+  if (exception)
+  {
+    try
+    {
+      std::rethrow_exception(exception);
+    }
+    catch (std::exception& e)
+    {
+      std::cerr << "Error: " << e.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "point oracle time cuts violation-lb violation-ub\n";
+  for (std::size_t p = 0; p < numPoints; ++p)
+  {
+    for (std::size_t o = 0; o < numOracles; ++o)
+    {
+      const ReplayCall& call = calls[p * numOracles + o];
+      std::cout << p << " " << options.oracles[o] << " " << std::fixed << std::setprecision(6) << call.time << " " << call.numCuts
+        << " " << std::defaultfloat << call.violationLowerBound << " " << call.violationUpperBound << "\n";
+    }
+  }
+  for (std::size_t o = 0; o < numOracles; ++o)
+  {
+    double time = 0.0;
+    std::size_t numCuts = 0;
+    std::size_t numSuccesses = 0;
+    for (std::size_t p = 0; p < numPoints; ++p)
+    {
+      time += calls[p * numOracles + o].time;
+      numCuts += calls[p * numOracles + o].numCuts;
+      if (calls[p * numOracles + o].numCuts > 0)
+        ++numSuccesses;
+    }
+    std::cout << "Oracle " << options.oracles[o] << ": " << numPoints << " calls, " << numSuccesses << " successful, " << numCuts
+      << " cuts, " << time << "s." << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
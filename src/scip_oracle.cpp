@@ -1,19 +1,182 @@
 #include "scip_oracle.h"
 
+#include <algorithm>
+#include <exception>
 #include <iostream>
-#include <sstream>
 #include <limits>
+#include <stdexcept>
+#include <thread>
 
 #include <scip/scipdefplugins.h>
 
-MaximumWeightRectangleIPOracle::MaximumWeightRectangleIPOracle(const Slackmatrix& slackmatrix, int priority)
-  : SeparationOracle(slackmatrix.nonzeros.size(), priority)
+#define EVENTHDLR_NAME "violatedrectangles"
+
+static
+SCIP_DECL_EVENTINIT(eventInitViolatedRectangles)
+{
+  SCIP_CALL( SCIPcatchEvent(scip, SCIP_EVENTTYPE_SOLFOUND | SCIP_EVENTTYPE_NODESOLVED, eventhdlr, NULL, NULL) );
+  return SCIP_OKAY;
+}
+
+static
+SCIP_DECL_EVENTEXIT(eventExitViolatedRectangles)
+{
+  SCIP_CALL( SCIPdropEvent(scip, SCIP_EVENTTYPE_SOLFOUND | SCIP_EVENTTYPE_NODESOLVED, eventhdlr, NULL, -1) );
+  return SCIP_OKAY;
+}
+
+/* Streams violated rectangles as they are found and interrupts the solve as soon as the requested number of them was found or an
+ * interruption was requested from outside. */
+
+static
+SCIP_DECL_EVENTEXEC(eventExecViolatedRectangles)
+{
+  SCIP_EVENTHDLRDATA* data = SCIPeventhdlrGetData(eventhdlr);
+  if (SCIPeventGetType(event) & SCIP_EVENTTYPE_NODESOLVED)
+  {
+    if (data->oracle != NULL && data->oracle->interruptRequested() && !SCIPisStopped(scip))
+      SCIP_CALL( SCIPinterruptSolve(scip) );
+
+    // Prune with rectangles of concurrent solves. The objective limit may only be raised while solving.
+
+    if (data->sharedIncumbent != NULL && *data->sharedIncumbent > SCIPgetObjlimit(scip) && !SCIPisStopped(scip))
+      SCIP_CALL( SCIPsetObjlimit(scip, *data->sharedIncumbent) );
+    return SCIP_OKAY;
+  }
+
+  SCIP_SOL* sol = SCIPeventGetSol(event);
+  double weight = SCIPgetSolOrigObj(scip, sol);
+  if (data->sharedIncumbent != NULL)
+  {
+    double incumbent = *data->sharedIncumbent;
+    while (weight > incumbent && !data->sharedIncumbent->compare_exchange_weak(incumbent, weight));
+  }
+  if (weight <= data->threshold)
+    return SCIP_OKAY;
+
+  ++data->count;
+  if (data->stream != NULL)
+  {
+    cpm::Rectangle rectangle;
+    for (std::size_t r = 0; r < data->rowVariables->size(); ++r)
+    {
+      if (SCIPgetSolVal(scip, sol, (*data->rowVariables)[r]) > 0.5)
+        rectangle.rows.push_back(r);
+    }
+    for (std::size_t c = 0; c < data->columnVariables->size(); ++c)
+    {
+      if (SCIPgetSolVal(scip, sol, (*data->columnVariables)[c]) > 0.5)
+        rectangle.columns.push_back(c);
+    }
+    (*data->stream)(rectangle);
+  }
+  if (data->limit > 0 && data->count >= data->limit && !SCIPisStopped(scip))
+    SCIP_CALL( SCIPinterruptSolve(scip) );
+  return SCIP_OKAY;
+}
+
+/* Undoes the changes of a call to the shared model when the call ends, also if it ends with an exception, i.e., releases the fixings,
+ * removes the row range and restores the objective limit. Errors are ignored since the destructor must not throw. */
+
+class SolveGuard
 {
-  _slackmatrix = new Slackmatrix(slackmatrix.numRows, slackmatrix.numColumns, slackmatrix.nonzeros);
+public:
+  SolveGuard(SCIP* scip, const std::vector<SCIP_VAR*>& variables)
+    : _scip(scip), _variables(variables), _objectiveLimit(SCIPgetObjlimit(scip)), _forcedVariable(NULL), _rangeConstraint(NULL)
+  {
+
+  }
+
+  ~SolveGuard()
+  {
+    if (SCIPgetStage(_scip) > SCIP_STAGE_PROBLEM)
+      SCIPfreeTransform(_scip);
+    for (std::size_t v = 0; v < _variables.size(); ++v)
+      SCIPchgVarUb(_scip, _variables[v], 1.0);
+    if (_forcedVariable != NULL)
+      SCIPchgVarLb(_scip, _forcedVariable, 0.0);
+    if (_rangeConstraint != NULL)
+    {
+      SCIPdelCons(_scip, _rangeConstraint);
+      SCIPreleaseCons(_scip, &_rangeConstraint);
+    }
+    SCIPsetObjlimit(_scip, _objectiveLimit);
+  }
+
+  inline double objectiveLimit() const
+  {
+    return _objectiveLimit;
+  }
+
+  /* Variable fixed to 1 for this call. */
+
+  inline void setForcedVariable(SCIP_VAR* variable)
+  {
+    _forcedVariable = variable;
+  }
+
+  /* Constraint added for this call, which the guard releases. */
+
+  inline void setRangeConstraint(SCIP_CONS* constraint)
+  {
+    _rangeConstraint = constraint;
+  }
+
+protected:
+  SCIP* _scip;
+  const std::vector<SCIP_VAR*>& _variables;
+  double _objectiveLimit;
+  SCIP_VAR* _forcedVariable;
+  SCIP_CONS* _rangeConstraint;
+};
+
+MaximumWeightRectangleIPModel::MaximumWeightRectangleIPModel(const Slackmatrix& slackmatrix, bool names)
+  : _slackmatrix(slackmatrix), _names(names), _scip(NULL)
+{
+  _eventhdlrData.threshold = 1.0 + 1.0e-3;
+  _eventhdlrData.limit = 0;
+  _eventhdlrData.count = 0;
+  _eventhdlrData.stream = NULL;
+  _eventhdlrData.rowVariables = &_rowVariables;
+  _eventhdlrData.columnVariables = &_columnVariables;
+  _eventhdlrData.oracle = NULL;
+  _eventhdlrData.sharedIncumbent = NULL;
+}
+
+MaximumWeightRectangleIPModel::~MaximumWeightRectangleIPModel()
+{
+  if (_scip == NULL)
+    return;
+
+  for (std::size_t row = 0; row < _rowVariables.size(); ++row)
+    SCIP_CALL_EXC( SCIPreleaseVar(_scip, &_rowVariables[row]) );
+  for (std::size_t column = 0; column < _columnVariables.size(); ++column)
+    SCIP_CALL_EXC( SCIPreleaseVar(_scip, &_columnVariables[column]) );
+  for (std::size_t i = 0; i < _nonzeroVariables.size(); ++i)
+  {
+    SCIP_CALL_EXC( SCIPreleaseVar(_scip, &_nonzeroVariables[i]) );
+  }
+  
+  SCIP_CALL_EXC(SCIPfreeProb(_scip));
+  SCIP_CALL_EXC(SCIPfree(&_scip));
+}
+
+void MaximumWeightRectangleIPModel::build()
+{
+  // Without names, all variables and constraints share the empty name. The name hash tables would then degrade, so they are disabled,
+  // which must happen before the problem is created.
+
+  char name[SCIP_MAXSTRLEN];
+  name[0] = '\0';
 
   SCIP_CALL_EXC(SCIPcreate(&_scip));
-  SCIP_CALL_EXC(SCIPcreateProbBasic(_scip, "max-weight-rectangle"));
   SCIP_CALL_EXC(SCIPincludeDefaultPlugins(_scip));
+  if (!_names)
+  {
+    SCIP_CALL_EXC(SCIPsetBoolParam(_scip, "misc/usevartable", false));
+    SCIP_CALL_EXC(SCIPsetBoolParam(_scip, "misc/useconstable", false));
+  }
+  SCIP_CALL_EXC(SCIPcreateProbBasic(_scip, "max-weight-rectangle"));
   SCIP_CALL_EXC(SCIPsetIntParam(_scip, "display/verblevel", 0));
   SCIP_CALL_EXC(SCIPsetObjlimit(_scip, 1.0));
   SCIP_CALL_EXC(SCIPsetBoolParam(_scip, "misc/catchctrlc", false));
@@ -24,46 +187,53 @@ MaximumWeightRectangleIPOracle::MaximumWeightRectangleIPOracle(const Slackmatrix
   SCIP_CALL_EXC(SCIPsetIntParam(_scip, "separating/clique/freq", -1));
   SCIP_CALL_EXC(SCIPsetIntParam(_scip, "separating/impliedbounds/freq", -1));
 
-  _rowVariables.resize(_slackmatrix->numRows);
-  for (std::size_t row = 0; row < _slackmatrix->numRows; ++row)
+  SCIP_EVENTHDLR* eventhdlr = NULL;
+  SCIP_CALL_EXC(SCIPincludeEventhdlrBasic(_scip, &eventhdlr, EVENTHDLR_NAME, "interrupts after enough violated rectangles",
+    eventExecViolatedRectangles, &_eventhdlrData));
+  SCIP_CALL_EXC(SCIPsetEventhdlrInit(_scip, eventhdlr, eventInitViolatedRectangles));
+  SCIP_CALL_EXC(SCIPsetEventhdlrExit(_scip, eventhdlr, eventExitViolatedRectangles));
+
+  _rowVariables.resize(_slackmatrix.numRows);
+  for (std::size_t row = 0; row < _slackmatrix.numRows; ++row)
   {
-    std::stringstream ss;
-    ss << "row#" << row;
-    SCIP_CALL_EXC(SCIPcreateVarBasic(_scip, &_rowVariables[row], ss.str().c_str(), 0.0, 1.0, 0.0, SCIP_VARTYPE_BINARY));
+    if (_names)
+      SCIPsnprintf(name, SCIP_MAXSTRLEN, "row#%lu", (unsigned long) row);
+    SCIP_CALL_EXC(SCIPcreateVarBasic(_scip, &_rowVariables[row], name, 0.0, 1.0, 0.0, SCIP_VARTYPE_BINARY));
     SCIP_CALL_EXC(SCIPaddVar(_scip, _rowVariables[row]));
   }
 
-  _columnVariables.resize(_slackmatrix->numColumns);
-  for (std::size_t column = 0; column < _slackmatrix->numColumns; ++column)
+  _columnVariables.resize(_slackmatrix.numColumns);
+  for (std::size_t column = 0; column < _slackmatrix.numColumns; ++column)
   {
-    std::stringstream ss;
-    ss << "column#" << column;
-    SCIP_CALL_EXC(SCIPcreateVarBasic(_scip, &_columnVariables[column], ss.str().c_str(), 0.0, 1.0, 0.0, SCIP_VARTYPE_BINARY));
+    if (_names)
+      SCIPsnprintf(name, SCIP_MAXSTRLEN, "column#%lu", (unsigned long) column);
+    SCIP_CALL_EXC(SCIPcreateVarBasic(_scip, &_columnVariables[column], name, 0.0, 1.0, 0.0, SCIP_VARTYPE_BINARY));
     SCIP_CALL_EXC(SCIPaddVar(_scip, _columnVariables[column]));
   }
 
-  _nonzeroVariables.resize(_slackmatrix->nonzeros.size());
+  _nonzeroVariables.resize(_slackmatrix.nonzeros.size());
   for (std::size_t i = 0; i < _nonzeroVariables.size(); ++i)
   {
-    std::stringstream ss;
-    ss << "nonzero#" << i << "#row#" << _slackmatrix->nonzeros[i].row << "#column#" << _slackmatrix->nonzeros[i].column;
-    SCIP_CALL_EXC(SCIPcreateVarBasic(_scip, &_nonzeroVariables[i], ss.str().c_str(), 0.0, 1.0, 0.0, SCIP_VARTYPE_BINARY));
+    if (_names)
+      SCIPsnprintf(name, SCIP_MAXSTRLEN, "nonzero#%lu#row#%lu#column#%lu", (unsigned long) i,
+        (unsigned long) _slackmatrix.nonzeros[i].row, (unsigned long) _slackmatrix.nonzeros[i].column);
+    SCIP_CALL_EXC(SCIPcreateVarBasic(_scip, &_nonzeroVariables[i], name, 0.0, 1.0, 0.0, SCIP_VARTYPE_BINARY));
     SCIP_CALL_EXC(SCIPaddVar(_scip, _nonzeroVariables[i]));
   }
 
   // x_row + y_column <= 1 for zero entry (row,column).
 
-  for (std::size_t row = 0; row < _slackmatrix->numRows; ++row)
+  for (std::size_t row = 0; row < _slackmatrix.numRows; ++row)
   {
-    for (std::size_t column = 0; column < _slackmatrix->numColumns; ++column)
+    for (std::size_t column = 0; column < _slackmatrix.numColumns; ++column)
     {
-      if (_slackmatrix->denseIndices[row][column] < std::numeric_limits<std::size_t>::max())
+      if (_slackmatrix.denseIndices[row][column] < std::numeric_limits<std::size_t>::max())
         continue;
 
       SCIP_CONS* cons = NULL;
-      std::stringstream ss;
-      ss << "zero#" << row << "#" << column;
-      SCIP_CALL_EXC(SCIPcreateConsBasicLinear(_scip, &cons, ss.str().c_str(), 0, NULL, NULL, -SCIPinfinity(_scip), 1.0));
+      if (_names)
+        SCIPsnprintf(name, SCIP_MAXSTRLEN, "zero#%lu#%lu", (unsigned long) row, (unsigned long) column);
+      SCIP_CALL_EXC(SCIPcreateConsBasicLinear(_scip, &cons, name, 0, NULL, NULL, -SCIPinfinity(_scip), 1.0));
       SCIP_CALL_EXC(SCIPaddCoefLinear(_scip, cons, _rowVariables[row], 1.0));
       SCIP_CALL_EXC(SCIPaddCoefLinear(_scip, cons, _columnVariables[column], 1.0));
       SCIP_CALL_EXC(SCIPaddCons(_scip, cons));
@@ -73,13 +243,14 @@ MaximumWeightRectangleIPOracle::MaximumWeightRectangleIPOracle(const Slackmatrix
 
   // x_row - z_i >= 0 for i'th nonzero (row,column).
 
-  for (std::size_t i = 0; i < _slackmatrix->nonzeros.size(); ++i)
+  for (std::size_t i = 0; i < _slackmatrix.nonzeros.size(); ++i)
   {
     SCIP_CONS* cons = NULL;
-    std::stringstream ss;
-    ss << "nonzero#" << i << "#row#" << _slackmatrix->nonzeros[i].row;
-    SCIP_CALL_EXC(SCIPcreateConsBasicLinear(_scip, &cons, ss.str().c_str(), 0, NULL, NULL, 0.0, 1.0));
-    SCIP_CALL_EXC(SCIPaddCoefLinear(_scip, cons, _rowVariables[_slackmatrix->nonzeros[i].row], 1.0));
+    if (_names)
+      SCIPsnprintf(name, SCIP_MAXSTRLEN, "nonzero#%lu#row#%lu", (unsigned long) i,
+        (unsigned long) _slackmatrix.nonzeros[i].row);
+    SCIP_CALL_EXC(SCIPcreateConsBasicLinear(_scip, &cons, name, 0, NULL, NULL, 0.0, 1.0));
+    SCIP_CALL_EXC(SCIPaddCoefLinear(_scip, cons, _rowVariables[_slackmatrix.nonzeros[i].row], 1.0));
     SCIP_CALL_EXC(SCIPaddCoefLinear(_scip, cons, _nonzeroVariables[i], -1.0));
     SCIP_CALL_EXC(SCIPaddCons(_scip, cons));
     SCIP_CALL_EXC(SCIPreleaseCons(_scip, &cons));
@@ -87,13 +258,14 @@ MaximumWeightRectangleIPOracle::MaximumWeightRectangleIPOracle(const Slackmatrix
 
   // y_column - z_i >= 0 for i'th nonzero (row,column).
 
-  for (std::size_t i = 0; i < _slackmatrix->nonzeros.size(); ++i)
+  for (std::size_t i = 0; i < _slackmatrix.nonzeros.size(); ++i)
   {
     SCIP_CONS* cons = NULL;
-    std::stringstream ss;
-    ss << "nonzero#" << i << "#column#" << _slackmatrix->nonzeros[i].column;
-    SCIP_CALL_EXC(SCIPcreateConsBasicLinear(_scip, &cons, ss.str().c_str(), 0, NULL, NULL, 0.0, 1.0));
-    SCIP_CALL_EXC(SCIPaddCoefLinear(_scip, cons, _columnVariables[_slackmatrix->nonzeros[i].column], 1.0));
+    if (_names)
+      SCIPsnprintf(name, SCIP_MAXSTRLEN, "nonzero#%lu#column#%lu", (unsigned long) i,
+        (unsigned long) _slackmatrix.nonzeros[i].column);
+    SCIP_CALL_EXC(SCIPcreateConsBasicLinear(_scip, &cons, name, 0, NULL, NULL, 0.0, 1.0));
+    SCIP_CALL_EXC(SCIPaddCoefLinear(_scip, cons, _columnVariables[_slackmatrix.nonzeros[i].column], 1.0));
     SCIP_CALL_EXC(SCIPaddCoefLinear(_scip, cons, _nonzeroVariables[i], -1.0));
     SCIP_CALL_EXC(SCIPaddCons(_scip, cons));
     SCIP_CALL_EXC(SCIPreleaseCons(_scip, &cons));
@@ -101,113 +273,421 @@ MaximumWeightRectangleIPOracle::MaximumWeightRectangleIPOracle(const Slackmatrix
 
   // x_row + y_column - z_i <= 1 for i'th nonzero (row,column).
 
-  for (std::size_t i = 0; i < _slackmatrix->nonzeros.size(); ++i)
+  for (std::size_t i = 0; i < _slackmatrix.nonzeros.size(); ++i)
   {
     SCIP_CONS* cons = NULL;
-    std::stringstream ss;
-    ss << "nonzero#" << i << "#row#" << _slackmatrix->nonzeros[i].row << "#column#" << _slackmatrix->nonzeros[i].column;
-    SCIP_CALL_EXC(SCIPcreateConsBasicLinear(_scip, &cons, ss.str().c_str(), 0, NULL, NULL, -SCIPinfinity(_scip), 1.0));
-    SCIP_CALL_EXC(SCIPaddCoefLinear(_scip, cons, _rowVariables[_slackmatrix->nonzeros[i].row], 1.0));
-    SCIP_CALL_EXC(SCIPaddCoefLinear(_scip, cons, _columnVariables[_slackmatrix->nonzeros[i].column], 1.0));
+    if (_names)
+      SCIPsnprintf(name, SCIP_MAXSTRLEN, "nonzero#%lu#row#%lu#column#%lu", (unsigned long) i,
+        (unsigned long) _slackmatrix.nonzeros[i].row, (unsigned long) _slackmatrix.nonzeros[i].column);
+    SCIP_CALL_EXC(SCIPcreateConsBasicLinear(_scip, &cons, name, 0, NULL, NULL, -SCIPinfinity(_scip), 1.0));
+    SCIP_CALL_EXC(SCIPaddCoefLinear(_scip, cons, _rowVariables[_slackmatrix.nonzeros[i].row], 1.0));
+    SCIP_CALL_EXC(SCIPaddCoefLinear(_scip, cons, _columnVariables[_slackmatrix.nonzeros[i].column], 1.0));
     SCIP_CALL_EXC(SCIPaddCoefLinear(_scip, cons, _nonzeroVariables[i], -1.0));
     SCIP_CALL_EXC(SCIPaddCons(_scip, cons));
     SCIP_CALL_EXC(SCIPreleaseCons(_scip, &cons));
   }
 }
 
+MaximumWeightRectangleIPOracle::MaximumWeightRectangleIPOracle(const Slackmatrix& slackmatrix, int priority, bool names)
+  : SeparationOracle(slackmatrix.nonzeros.size(), priority), _model(new MaximumWeightRectangleIPModel(slackmatrix, names)),
+  _slackmatrix(&slackmatrix), _violatedSolutionLimit(0), _violationThreshold(1.0 + 1.0e-3), _restrictSupport(false),
+  _sharedIncumbent(NULL), _firstRow(0), _beyondRow(0)
+{
+
+}
+
+MaximumWeightRectangleIPOracle::MaximumWeightRectangleIPOracle(const std::shared_ptr<MaximumWeightRectangleIPModel>& model,
+  int priority)
+  : SeparationOracle(model->slackmatrix().nonzeros.size(), priority), _model(model), _slackmatrix(&model->slackmatrix()),
+  _violatedSolutionLimit(0), _violationThreshold(1.0 + 1.0e-3), _restrictSupport(false),
+  _sharedIncumbent(NULL), _firstRow(0), _beyondRow(0)
+{
+
+}
+
 MaximumWeightRectangleIPOracle::~MaximumWeightRectangleIPOracle()
 {
-  for (std::size_t row = 0; row < _slackmatrix->numRows; ++row)
-    SCIP_CALL_EXC( SCIPreleaseVar(_scip, &_rowVariables[row]) );
-  for (std::size_t column = 0; column < _slackmatrix->numColumns; ++column)
-    SCIP_CALL_EXC( SCIPreleaseVar(_scip, &_columnVariables[column]) );
-  for (std::size_t i = 0; i < _nonzeroVariables.size(); ++i)
-  {
-    SCIP_CALL_EXC( SCIPreleaseVar(_scip, &_nonzeroVariables[i]) );
-  }
-  
-  SCIP_CALL_EXC(SCIPfreeProb(_scip));
-  SCIP_CALL_EXC(SCIPfree(&_scip));
-  delete _slackmatrix;
+
 }
 
 void MaximumWeightRectangleIPOracle::separate(bool separatePoint, const double* vector, std::vector<double>& lhs, std::vector<double>& rhs,
   std::vector<std::size_t>& begin, std::vector<std::size_t>& indices, std::vector<double>& values, double& violationLowerBound,
   double& violationUpperBound)
+{
+  _rectangles.clear();
+  separateRectangles(vector, _rectangles, violationLowerBound, violationUpperBound);
+  _slackmatrix->appendInequalities(_rectangles, lhs, rhs, begin, indices, values);
+}
+
+bool MaximumWeightRectangleIPOracle::separateRectangles(const double* vector, std::vector<cpm::Rectangle>& rectangles,
+  double& violationLowerBound, double& violationUpperBound)
 {
 //     double dummy;
 //     SeparationOracle::separate(separatePoint, vector, lhs, rhs, begin, indices, values, violationLowerBound, dummy);
 
+  // The model is built on the first call of any of its oracles, which then take turns. An interrupt that arrived while waiting for the
+  // model or building it ends the call before the solve, without any rectangles.
+
+  std::lock_guard<std::mutex> lock(_model->_mutex);
+  if (!interruptRequested() && !_model->isBuilt())
+    _model->build();
+  if (interruptRequested())
+  {
+    _feasiblePoint.clear();
+    return true;
+  }
+  SCIP* scip = _model->_scip;
+  const std::vector<SCIP_VAR*>& rowVariables = _model->_rowVariables;
+  const std::vector<SCIP_VAR*>& columnVariables = _model->_columnVariables;
+  const std::vector<SCIP_VAR*>& nonzeroVariables = _model->_nonzeroVariables;
+  SCIP_EVENTHDLRDATA& eventhdlrData = _model->_eventhdlrData;
+  applyParams();
+
   for (std::size_t i = 0; i < _slackmatrix->nonzeros.size(); ++i)
   {
-    SCIP_CALL_EXC( SCIPchgVarObj(_scip, _nonzeroVariables[i], vector[i]) );
+    SCIP_CALL_EXC( SCIPchgVarObj(scip, nonzeroVariables[i], vector[i]) );
+  }
+
+  // Rows and columns without a positive entry can be removed from any rectangle without decreasing its weight, so fixing them to 0
+  // keeps the optimum. Entries in such a row or column are fixed as well.
+
+  _fixedVariables.clear();
+  SolveGuard solveGuard(scip, _fixedVariables);
+
+  // The first row of a rectangle lies in the range iff all earlier rows are excluded and some row of the range is selected. A single
+  // first row is simply fixed to 1.
+
+  bool emptyRange = false;
+  if (_beyondRow > 0)
+  {
+    for (std::size_t row = 0; row < _firstRow; ++row)
+    {
+      _fixedVariables.push_back(rowVariables[row]);
+      SCIP_CALL_EXC( SCIPchgVarUb(scip, rowVariables[row], 0.0) );
+    }
+    if (_beyondRow == _firstRow + 1)
+    {
+      SCIP_CALL_EXC( SCIPchgVarLb(scip, rowVariables[_firstRow], 1.0) );
+      solveGuard.setForcedVariable(rowVariables[_firstRow]);
+    }
+    else
+    {
+      SCIP_CONS* cons = NULL;
+      SCIP_CALL_EXC( SCIPcreateConsBasicLinear(scip, &cons, "rowrange", 0, NULL, NULL, 1.0, SCIPinfinity(scip)) );
+      solveGuard.setRangeConstraint(cons);
+      for (std::size_t row = _firstRow; row < _beyondRow; ++row)
+        SCIP_CALL_EXC( SCIPaddCoefLinear(scip, cons, rowVariables[row], 1.0) );
+      SCIP_CALL_EXC( SCIPaddCons(scip, cons) );
+    }
+  }
+
+  if (_restrictSupport)
+  {
+    std::vector<bool> positiveRows(_slackmatrix->numRows, false);
+    std::vector<bool> positiveColumns(_slackmatrix->numColumns, false);
+    for (std::size_t i = 0; i < _slackmatrix->nonzeros.size(); ++i)
+    {
+      if (vector[i] > 0.0)
+      {
+        positiveRows[_slackmatrix->nonzeros[i].row] = true;
+        positiveColumns[_slackmatrix->nonzeros[i].column] = true;
+      }
+    }
+    // A single first row without positive entries admits no rectangle, and fixing it to 0 and 1 at once would be invalid.
+
+    std::size_t numRangeFixings = _fixedVariables.size();
+    for (std::size_t row = _firstRow; row < _slackmatrix->numRows; ++row)
+    {
+      if (positiveRows[row])
+        continue;
+      if (row == _firstRow && _beyondRow == _firstRow + 1)
+        emptyRange = true;
+      else
+        _fixedVariables.push_back(rowVariables[row]);
+    }
+    for (std::size_t column = 0; column < _slackmatrix->numColumns; ++column)
+    {
+      if (!positiveColumns[column])
+        _fixedVariables.push_back(columnVariables[column]);
+    }
+    for (std::size_t i = 0; i < _slackmatrix->nonzeros.size(); ++i)
+    {
+      if (!positiveRows[_slackmatrix->nonzeros[i].row] || !positiveColumns[_slackmatrix->nonzeros[i].column])
+        _fixedVariables.push_back(nonzeroVariables[i]);
+    }
+    for (std::size_t v = numRangeFixings; v < _fixedVariables.size(); ++v)
+      SCIP_CALL_EXC( SCIPchgVarUb(scip, _fixedVariables[v], 0.0) );
+  }
+
+  // Rectangles of concurrent solves prune from the start.
+
+  if (_sharedIncumbent != NULL && *_sharedIncumbent > SCIPgetObjlimit(scip))
+    SCIP_CALL_EXC( SCIPsetObjlimit(scip, *_sharedIncumbent) );
+
+  // Solve with increasing limits until a violated rectangle was found or its absence was proved. The last stage uses the limits that
+  // were set before, which usually means an exact solve.
+
+  SCIP_Longint baseNodeLimit;
+  double baseGapLimit, baseTimeLimit;
+  SCIP_CALL_EXC( SCIPgetLongintParam(scip, "limits/nodes", &baseNodeLimit) );
+  SCIP_CALL_EXC( SCIPgetRealParam(scip, "limits/gap", &baseGapLimit) );
+  SCIP_CALL_EXC( SCIPgetRealParam(scip, "limits/time", &baseTimeLimit) );
+
+  eventhdlrData.limit = _violatedSolutionLimit;
+  eventhdlrData.threshold = _violationThreshold;
+  eventhdlrData.count = 0;
+  eventhdlrData.stream = _rectangleStream ? &_rectangleStream : NULL;
+  eventhdlrData.oracle = this;
+  eventhdlrData.sharedIncumbent = _sharedIncumbent;
+  for (std::size_t stage = 0; stage <= _escalationStages.size() && !emptyRange; ++stage)
+  {
+    if (stage < _escalationStages.size())
+    {
+      SCIP_CALL_EXC( SCIPsetLongintParam(scip, "limits/nodes", _escalationStages[stage].nodeLimit) );
+      SCIP_CALL_EXC( SCIPsetRealParam(scip, "limits/gap", _escalationStages[stage].gapLimit) );
+      SCIP_CALL_EXC( SCIPsetRealParam(scip, "limits/time", _escalationStages[stage].timeLimit) );
+    }
+    else
+    {
+      SCIP_CALL_EXC( SCIPsetLongintParam(scip, "limits/nodes", baseNodeLimit) );
+      SCIP_CALL_EXC( SCIPsetRealParam(scip, "limits/gap", baseGapLimit) );
+      SCIP_CALL_EXC( SCIPsetRealParam(scip, "limits/time", baseTimeLimit) );
+    }
+
+    SCIP_CALL_EXC( SCIPsolve(scip) );
+
+    if (eventhdlrData.count > 0 || interruptRequested() || SCIPgetStatus(scip) == SCIP_STATUS_OPTIMAL || SCIPgetStatus(scip) == SCIP_STATUS_INFEASIBLE
+      || SCIPgetDualbound(scip) <= eventhdlrData.threshold)
+    {
+      break;
+    }
   }
 
-  SCIP_CALL_EXC( SCIPsolve(_scip) );
+  // A solve that ends infeasible without any solution proves that no rectangle is heavier than the objective limit. A limit raised by a
+  // shared incumbent only excludes rectangles that are not heavier than it, so it bounds their weight along with the dual bound.
 
-  SCIP_SOL* bestSol = SCIPgetBestSol(_scip);
+  SCIP_SOL* bestSol = emptyRange ? NULL : SCIPgetBestSol(scip);
+  double objectiveLimit = SCIPgetObjlimit(scip);
   if (bestSol != NULL)
   {
-    double bestValue = SCIPgetSolOrigObj(_scip, SCIPgetBestSol(_scip));
+    double bestValue = SCIPgetSolOrigObj(scip, bestSol);
     violationLowerBound = bestValue - 1.0;
-    violationUpperBound = SCIPgetDualbound(_scip) - 1.0;
+    violationUpperBound = SCIPgetDualbound(scip) - 1.0;
+    if (objectiveLimit > solveGuard.objectiveLimit())
+      violationUpperBound = std::max(violationUpperBound, objectiveLimit - 1.0);
   }
+  else if (emptyRange || SCIPgetStatus(scip) == SCIP_STATUS_OPTIMAL || SCIPgetStatus(scip) == SCIP_STATUS_INFEASIBLE)
+    violationUpperBound = objectiveLimit - 1.0;
   
 //   SCIP_CUT** cuts = NULL;
-//   cuts = SCIPgetPoolCuts(_scip);
-//   for (int i = 0; i < SCIPgetNPoolCuts(_scip); ++i)
+//   cuts = SCIPgetPoolCuts(scip);
+//   for (int i = 0; i < SCIPgetNPoolCuts(scip); ++i)
 //   {
 //     SCIP_ROW* row = SCIPcutGetRow(cuts[i]);
-//     SCIPprintRow(_scip, row, stderr);
+//     SCIPprintRow(scip, row, stderr);
 //     std::cerr << std::endl;
 //   }
-//   SCIPprintStatistics(_scip, stderr);
-//   SCIP_CALL_EXC( SCIPprintBestSol(_scip, stdout, false) );
+//   SCIPprintStatistics(scip, stderr);
+//   SCIP_CALL_EXC( SCIPprintBestSol(scip, stdout, false) );
 
-  int numSols = SCIPgetNSols(_scip);
-  SCIP_SOL** sols = SCIPgetSols(_scip);
+  // Streamed rectangles were already reported by the event handler.
+
+  int numSols = eventhdlrData.stream != NULL || emptyRange ? 0 : SCIPgetNSols(scip);
+  SCIP_SOL** sols = SCIPgetSols(scip);
   for (int sol = 0; sol < numSols; ++sol)
   {
-    double objectiveValue = SCIPgetSolOrigObj(_scip, sols[sol]);
-    if (objectiveValue - 1.0 <= 1.0e-3) // TODO: epsilon
+    double objectiveValue = SCIPgetSolOrigObj(scip, sols[sol]);
+    if (objectiveValue <= eventhdlrData.threshold)
       continue;
 
-    lhs.push_back(-std::numeric_limits<double>::infinity());
-    rhs.push_back(1.0);
-    begin.push_back(indices.size());
+    // The zero constraints ensure that all selected rows and columns form an all-nonzero rectangle.
 
-    for (std::size_t v = 0; v < ambientDimension(); ++v)
+    rectangles.push_back(cpm::Rectangle());
+    for (std::size_t r = 0; r < rowVariables.size(); ++r)
     {
-      if (SCIPgetSolVal(_scip, sols[sol], _nonzeroVariables[v]) > 0.5)
-      {
-        indices.push_back(v);
-        values.push_back(1.0);
-      }
+      if (SCIPgetSolVal(scip, sols[sol], rowVariables[r]) > 0.5)
+        rectangles.back().rows.push_back(r);
+    }
+    for (std::size_t c = 0; c < columnVariables.size(); ++c)
+    {
+      if (SCIPgetSolVal(scip, sols[sol], columnVariables[c]) > 0.5)
+        rectangles.back().columns.push_back(c);
     }
 //     std::size_t numRectangleRows = 0;
-//     for (std::size_t r = 0; r < _rowVariables.size(); ++r)
+//     for (std::size_t r = 0; r < rowVariables.size(); ++r)
 //     {
-//       if (SCIPgetSolVal(_scip, sols[sol], _rowVariables[r]) > 0.5)
+//       if (SCIPgetSolVal(scip, sols[sol], rowVariables[r]) > 0.5)
 //         ++numRectangleRows;
 //     }
 //     std::size_t numRectangleColumns = 0;
-//     for (std::size_t c = 0; c < _columnVariables.size(); ++c)
+//     for (std::size_t c = 0; c < columnVariables.size(); ++c)
 //     {
-//       if (SCIPgetSolVal(_scip, sols[sol], _columnVariables[c]) > 0.5)
+//       if (SCIPgetSolVal(scip, sols[sol], columnVariables[c]) > 0.5)
 //         ++numRectangleColumns;
 //     }
 //     std::cerr << " [" << numRectangleRows << "x" << numRectangleColumns << " rect]" << std::flush;
+    if (_restrictSupport)
+      liftRectangle(vector, rectangles.back());
   }
 
+  _feasiblePoint.clear();
   if (violationUpperBound < 1000)
   {
     _feasiblePoint.resize(ambientDimension());
     for (std::size_t v = 0; v < ambientDimension(); ++v)
-      _feasiblePoint[v] = vector[v] / SCIPgetDualbound(_scip);
+      _feasiblePoint[v] = vector[v] / (1.0 + violationUpperBound);
+  }
+
+  SCIP_CALL_EXC( SCIPfreeSolve(scip, true) );
+  SCIP_CALL_EXC( SCIPfreeTransform(scip) );
+
+  if (!_escalationStages.empty())
+  {
+    SCIP_CALL_EXC( SCIPsetLongintParam(scip, "limits/nodes", baseNodeLimit) );
+    SCIP_CALL_EXC( SCIPsetRealParam(scip, "limits/gap", baseGapLimit) );
+    SCIP_CALL_EXC( SCIPsetRealParam(scip, "limits/time", baseTimeLimit) );
+  }
+
+  eventhdlrData.oracle = NULL;
+  eventhdlrData.sharedIncumbent = NULL;
+  eventhdlrData.stream = NULL;
+
+  return true;
+}
+
+void MaximumWeightRectangleIPOracle::applyParams()
+{
+  // Parameters set by another oracle on the same model are reset to their defaults first.
+
+  SCIP* scip = _model->_scip;
+  std::set<std::string>& changedParams = _model->_changedParams;
+  for (std::set<std::string>::const_iterator iter = changedParams.begin(); iter != changedParams.end(); ++iter)
+  {
+    if (_intParams.find(*iter) == _intParams.end() && _realParams.find(*iter) == _realParams.end())
+      SCIP_CALL_EXC( SCIPresetParam(scip, iter->c_str()) );
+  }
+  changedParams.clear();
+  for (std::map<std::string, int>::const_iterator iter = _intParams.begin(); iter != _intParams.end(); ++iter)
+  {
+    SCIP_CALL_EXC( SCIPsetIntParam(scip, iter->first.c_str(), iter->second) );
+    changedParams.insert(iter->first);
+  }
+  for (std::map<std::string, double>::const_iterator iter = _realParams.begin(); iter != _realParams.end(); ++iter)
+  {
+    SCIP_CALL_EXC( SCIPsetRealParam(scip, iter->first.c_str(), iter->second) );
+    changedParams.insert(iter->first);
+  }
+}
+
+void MaximumWeightRectangleIPOracle::liftRectangle(const double* vector, cpm::Rectangle& rectangle) const
+{
+  const std::size_t none = std::numeric_limits<std::size_t>::max();
+
+  // Alternately add every row and every column whose entries in the rectangle are all nonzero and have nonnegative total weight. A
+  // line rejected for its weight may be accepted after lines of the other kind were added, so this is repeated until nothing changes.
+
+  std::vector<bool> selectedRows(_slackmatrix->numRows, false);
+  for (std::size_t r = 0; r < rectangle.rows.size(); ++r)
+    selectedRows[rectangle.rows[r]] = true;
+  std::vector<bool> selectedColumns(_slackmatrix->numColumns, false);
+  for (std::size_t c = 0; c < rectangle.columns.size(); ++c)
+    selectedColumns[rectangle.columns[c]] = true;
+  for (bool first = true; ; first = false)
+  {
+    bool added = false;
+    for (std::size_t row = 0; row < _slackmatrix->numRows; ++row)
+    {
+      if (selectedRows[row])
+        continue;
+
+      double weight = 0.0;
+      std::size_t c = 0;
+      for (; c < rectangle.columns.size(); ++c)
+      {
+        std::size_t i = _slackmatrix->denseIndices[row][rectangle.columns[c]];
+        if (i == none)
+          break;
+        weight += vector[i];
+      }
+      if (c == rectangle.columns.size() && weight >= 0.0)
+      {
+        rectangle.rows.push_back(row);
+        selectedRows[row] = true;
+        added = true;
+      }
+    }
+    if (!added && !first)
+      break;
+
+    added = false;
+    for (std::size_t column = 0; column < _slackmatrix->numColumns; ++column)
+    {
+      if (selectedColumns[column])
+        continue;
+
+      double weight = 0.0;
+      std::size_t r = 0;
+      for (; r < rectangle.rows.size(); ++r)
+      {
+        std::size_t i = _slackmatrix->denseIndices[rectangle.rows[r]][column];
+        if (i == none)
+          break;
+        weight += vector[i];
+      }
+      if (r == rectangle.rows.size() && weight >= 0.0)
+      {
+        rectangle.columns.push_back(column);
+        selectedColumns[column] = true;
+        added = true;
+      }
+    }
+    if (!added)
+      break;
+  }
+  rectangle.normalize();
+}
+
+void MaximumWeightRectangleIPOracle::setSupportRestriction(bool restrict)
+{
+  _restrictSupport = restrict;
+}
+
+void MaximumWeightRectangleIPOracle::setSharedIncumbent(std::atomic<double>* incumbent)
+{
+  _sharedIncumbent = incumbent;
+}
+
+void MaximumWeightRectangleIPOracle::setRowRange(std::size_t firstRow, std::size_t beyondRow)
+{
+  if (beyondRow > 0 && (firstRow >= beyondRow || beyondRow > _slackmatrix->numRows))
+    throw std::runtime_error("MaximumWeightRectangleIPOracle: Invalid row range.");
+
+  _firstRow = beyondRow > 0 ? firstRow : 0;
+  _beyondRow = beyondRow;
+}
+
+void partitionFirstRows(std::size_t numRows, std::size_t numBlocks, std::vector<std::size_t>& boundaries)
+{
+  boundaries.assign(1, 0);
+  if (numRows == 0)
+    return;
+
+  numBlocks = std::max<std::size_t>(std::min(numBlocks, numRows), 1);
+  for (std::size_t b = 1; b <= numBlocks; ++b)
+  {
+    double fraction = double(b) / numBlocks;
+    std::size_t boundary = static_cast<std::size_t>(numRows * fraction * fraction);
+    boundary = std::max(boundary, boundaries.back() + 1);
+    boundaries.push_back(std::min(boundary, numRows - (numBlocks - b)));
   }
+}
 
-  SCIP_CALL_EXC( SCIPfreeSolve(_scip, true) );
-  SCIP_CALL_EXC( SCIPfreeTransform(_scip) );
+void MaximumWeightRectangleIPOracle::interrupt()
+{
+  // SCIP may only be interrupted from its own thread, so the event handler checks the request of the solving oracle after every node.
+  // A solve of another oracle on the same model is left alone.
+
+  cpm::SeparationOracle::interrupt();
 }
 
 void MaximumWeightRectangleIPOracle::getFeasiblePointProperties(bool& scaledDown, bool& scaledUp, std::vector<std::size_t>& modifiableVariables) const
@@ -230,13 +710,161 @@ void MaximumWeightRectangleIPOracle::getFeasiblePoint(std::size_t id, std::vecto
 
 void MaximumWeightRectangleIPOracle::setDoubleParam(const std::string& param, double value)
 {
-  SCIP_CALL_EXC(SCIPsetRealParam(_scip, param.c_str(), value));
+  _realParams[param] = value;
 }
 
 
 void MaximumWeightRectangleIPOracle::setIntParam(const std::string& param, int value)
 {
-  SCIP_CALL_EXC(SCIPsetIntParam(_scip, param.c_str(), value));
+  _intParams[param] = value;
+}
+
+void MaximumWeightRectangleIPOracle::setViolatedSolutionLimit(int limit, double epsilon)
+{
+  _violatedSolutionLimit = limit;
+  _violationThreshold = 1.0 + epsilon;
+}
+
+void MaximumWeightRectangleIPOracle::addEscalationStage(long long nodeLimit, double gapLimit, double timeLimit)
+{
+  EscalationStage stage = { nodeLimit, gapLimit, timeLimit };
+  _escalationStages.push_back(stage);
+}
+
+void MaximumWeightRectangleIPOracle::clearEscalationStages()
+{
+  _escalationStages.clear();
+}
+
+
+MaximumWeightRectangleParallelIPOracle::MaximumWeightRectangleParallelIPOracle(const Slackmatrix& slackmatrix, int priority,
+  std::size_t numThreads)
+  : SeparationOracle(slackmatrix.nonzeros.size(), priority), _slackmatrix(slackmatrix), _nextBlock(0), _incumbent(0.0)
+{
+  numThreads = std::max<std::size_t>(std::min(numThreads, slackmatrix.numRows), 1);
+  partitionFirstRows(slackmatrix.numRows, 8 * numThreads, _blockBoundaries);
+  for (std::size_t t = 0; t < numThreads; ++t)
+  {
+    _oracles.push_back(std::unique_ptr<MaximumWeightRectangleIPOracle>(new MaximumWeightRectangleIPOracle(slackmatrix, priority)));
+    _oracles.back()->setSharedIncumbent(&_incumbent);
+  }
 }
 
+MaximumWeightRectangleParallelIPOracle::~MaximumWeightRectangleParallelIPOracle()
+{
 
+}
+
+void MaximumWeightRectangleParallelIPOracle::separate(bool separatePoint, const double* vector, std::vector<double>& lhs,
+  std::vector<double>& rhs, std::vector<std::size_t>& begin, std::vector<std::size_t>& indices, std::vector<double>& values,
+  double& violationLowerBound, double& violationUpperBound)
+{
+  _rectangles.clear();
+  separateRectangles(vector, _rectangles, violationLowerBound, violationUpperBound);
+  _slackmatrix.appendInequalities(_rectangles, lhs, rhs, begin, indices, values);
+}
+
+bool MaximumWeightRectangleParallelIPOracle::separateRectangles(const double* vector, std::vector<cpm::Rectangle>& rectangles,
+  double& violationLowerBound, double& violationUpperBound)
+{
+  // The incumbent starts without any rectangle, so that the first limits come from actual solutions. Each thread takes the next block
+  // of first rows whenever its solve ends, and stops taking blocks once interrupted. A block whose solve proves nothing leaves its upper
+  // bound at infinity.
+
+  _incumbent = -std::numeric_limits<double>::infinity();
+  _nextBlock = 0;
+  std::size_t numBlocks = _blockBoundaries.size() - 1;
+  std::size_t numThreads = _oracles.size();
+  std::vector<std::vector<cpm::Rectangle> > threadRectangles(numThreads);
+  std::vector<double> lowerBounds(numThreads, 0.0);
+  std::vector<double> upperBounds(numThreads, -std::numeric_limits<double>::infinity());
+  std::vector<std::exception_ptr> exceptions(numThreads);
+  std::atomic<std::size_t> numSolvedBlocks(0);
+  auto solve = [&](std::size_t t)
+  {
+    try
+    {
+      for (std::size_t block = _nextBlock++; block < numBlocks && !interruptRequested(); block = _nextBlock++)
+      {
+        double lowerBound = 0.0;
+        double upperBound = std::numeric_limits<double>::max();
+        _oracles[t]->setRowRange(_blockBoundaries[block], _blockBoundaries[block + 1]);
+        _oracles[t]->separateRectangles(vector, threadRectangles[t], lowerBound, upperBound);
+        lowerBounds[t] = std::max(lowerBounds[t], lowerBound);
+        upperBounds[t] = std::max(upperBounds[t], upperBound);
+        ++numSolvedBlocks;
+      }
+    }
+    catch (...)
+    {
+      exceptions[t] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> threads;
+  for (std::size_t t = 1; t < numThreads; ++t)
+    threads.push_back(std::thread(solve, t));
+  solve(0);
+  for (std::size_t t = 0; t < threads.size(); ++t)
+    threads[t].join();
+  for (std::size_t t = 0; t < numThreads; ++t)
+  {
+    if (exceptions[t])
+      std::rethrow_exception(exceptions[t]);
+  }
+
+  // The blocks cover all rectangles, so the maximum of their upper bounds is exact, unless some were skipped by an interrupt.
+
+  double maxUpperBound = -std::numeric_limits<double>::infinity();
+  for (std::size_t t = 0; t < numThreads; ++t)
+  {
+    rectangles.insert(rectangles.end(), threadRectangles[t].begin(), threadRectangles[t].end());
+    violationLowerBound = std::max(violationLowerBound, lowerBounds[t]);
+    maxUpperBound = std::max(maxUpperBound, upperBounds[t]);
+  }
+  if (numSolvedBlocks < numBlocks)
+    maxUpperBound = std::numeric_limits<double>::max();
+  violationUpperBound = maxUpperBound;
+
+  _feasiblePoint.clear();
+  if (maxUpperBound < 1000 && maxUpperBound > -1.0)
+  {
+    _feasiblePoint.resize(ambientDimension());
+    for (std::size_t v = 0; v < ambientDimension(); ++v)
+      _feasiblePoint[v] = vector[v] / (1.0 + maxUpperBound);
+  }
+
+  return true;
+}
+
+void MaximumWeightRectangleParallelIPOracle::beginCall()
+{
+  cpm::SeparationOracle::beginCall();
+  for (std::size_t p = 0; p < _oracles.size(); ++p)
+    _oracles[p]->beginCall();
+}
+
+void MaximumWeightRectangleParallelIPOracle::interrupt()
+{
+  cpm::SeparationOracle::interrupt();
+  for (std::size_t p = 0; p < _oracles.size(); ++p)
+    _oracles[p]->interrupt();
+}
+
+void MaximumWeightRectangleParallelIPOracle::getFeasiblePointProperties(bool& scaledDown, bool& scaledUp,
+  std::vector<std::size_t>& modifiableVariables) const
+{
+  cpm::SeparationOracle::getFeasiblePointProperties(scaledDown, scaledUp, modifiableVariables);
+  scaledDown = true;
+}
+
+std::size_t MaximumWeightRectangleParallelIPOracle::numFeasiblePoints() const
+{
+  return _feasiblePoint.empty() ? 0 : 1;
+}
+
+void MaximumWeightRectangleParallelIPOracle::getFeasiblePoint(std::size_t id, std::vector<double>& point) const
+{
+  if (id >= numFeasiblePoints())
+    throw std::runtime_error("Invalid index while querying a feasible point.");
+  point = _feasiblePoint;
+}
@@ -1,6 +1,12 @@
 #ifndef _SCIP_ORACLE_H_
 #define _SCIP_ORACLE_H_
 
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
 #include <scip/scip.h>
 
 #include <cpm/separation_oracle.h>
@@ -8,10 +14,76 @@
 #include "scip_exception.h"
 #include "slackmatrix.h"
 
+struct SCIP_EventhdlrData
+{
+  double threshold;
+  int limit;
+  int count;
+  const cpm::SeparationOracle::RectangleStream* stream;
+  const std::vector<SCIP_VAR*>* rowVariables;
+  const std::vector<SCIP_VAR*>* columnVariables;
+  const cpm::SeparationOracle* oracle;
+  std::atomic<double>* sharedIncumbent;
+};
+
+class MaximumWeightRectangleIPOracle;
+
+/**
+ * SCIP model of the maximum-weight rectangle IP of a matrix. It is only built on first use and can be shared by several oracles that
+ * differ in their solve parameters only, in which case their solves are serialized. The matrix must outlive the model.
+ */
+
+class MaximumWeightRectangleIPModel
+{
+public:
+  /**
+   * Variables and constraints of the IP are only named if names is true, which is useful for debugging but costly for large matrices.
+   */
+
+  MaximumWeightRectangleIPModel(const Slackmatrix& slackmatrix, bool names = false);
+
+  ~MaximumWeightRectangleIPModel();
+
+  inline const Slackmatrix& slackmatrix() const
+  {
+    return _slackmatrix;
+  }
+
+  inline bool isBuilt() const
+  {
+    return _scip != NULL;
+  }
+
+protected:
+  friend class MaximumWeightRectangleIPOracle;
+
+  void build();
+
+  const Slackmatrix& _slackmatrix;
+  bool _names;
+  SCIP* _scip;
+  std::vector<SCIP_VAR*> _rowVariables;
+  std::vector<SCIP_VAR*> _columnVariables;
+  std::vector<SCIP_VAR*> _nonzeroVariables;
+  SCIP_EVENTHDLRDATA _eventhdlrData;
+  std::mutex _mutex;
+  std::set<std::string> _changedParams;
+};
+
 class MaximumWeightRectangleIPOracle : public cpm::SeparationOracle
 {
 public:
-  MaximumWeightRectangleIPOracle(const Slackmatrix& slackmatrix, int priority);
+  /**
+   * Creates an oracle with a model of its own, which is built on the first separation.
+   */
+
+  MaximumWeightRectangleIPOracle(const Slackmatrix& slackmatrix, int priority, bool names = false);
+
+  /**
+   * Creates an oracle on a model that may be shared with other oracles.
+   */
+
+  MaximumWeightRectangleIPOracle(const std::shared_ptr<MaximumWeightRectangleIPModel>& model, int priority);
 
   virtual ~MaximumWeightRectangleIPOracle();
 
@@ -19,22 +91,152 @@ public:
     std::vector<std::size_t>& begin, std::vector<std::size_t>& indices, std::vector<double>& values, double& violationLowerBound,
     double& violationUpperBound);
 
+  virtual bool separateRectangles(const double* vector, std::vector<cpm::Rectangle>& rectangles, double& violationLowerBound,
+    double& violationUpperBound);
+
+  /**
+   * Asks the solve of the current generation to stop at the next processed node, even if it has not started yet. May be called from
+   * any thread.
+   */
+
+  virtual void interrupt();
+
   virtual void getFeasiblePointProperties(bool& scaledDown, bool& scaledUp, std::vector< std::size_t >& modifiableVariables) const;
 
   virtual std::size_t numFeasiblePoints() const;
 
   virtual void getFeasiblePoint(std::size_t id, std::vector<double>& point) const;
 
+  /**
+   * SCIP parameters are stored per oracle and set before each of its solves.
+   */
+
   void setDoubleParam(const std::string& param, double value);
   
   void setIntParam(const std::string& param, int value);
 
+  void setViolatedSolutionLimit(int limit, double epsilon = 1.0e-3);
+
+  /**
+   * If enabled, every call fixes rows and columns without a positive-weight entry to zero, which keeps the optimum, and lifts the
+   * resulting rectangles by adding rows and columns whose entries in the rectangle are all nonzero and of nonnegative total weight
+   * until no such line is left.
+   */
+
+  void setSupportRestriction(bool restrict);
+
+  /**
+   * Restricts the following calls to rectangles whose first row lies in [firstRow, beyondRow), or lifts the restriction if beyondRow
+   * is 0. Calls for a partition of the rows together cover all rectangles, and the maximum of their results is exact. The range is
+   * applied to the model for each solve only, so it may be changed between calls and does not affect other oracles on the model.
+   */
+
+  void setRowRange(std::size_t firstRow, std::size_t beyondRow);
+
+  void addEscalationStage(long long nodeLimit, double gapLimit, double timeLimit);
+
+  void clearEscalationStages();
+
+  /**
+   * Lets the solves of this oracle publish the weight of every rectangle they find to the given incumbent, which is raised
+   * atomically, and use it as an objective limit as soon as it exceeds theirs. Concurrent oracles for different row ranges can thus
+   * prune with each other's rectangles, but then return fewer violated rectangles that are lighter than the incumbent. NULL disables
+   * sharing.
+   */
+
+  void setSharedIncumbent(std::atomic<double>* incumbent);
+
 protected:
+  struct EscalationStage
+  {
+    long long nodeLimit;
+    double gapLimit;
+    double timeLimit;
+  };
+
+  void liftRectangle(const double* vector, cpm::Rectangle& rectangle) const;
+
+  void applyParams();
+
+  std::shared_ptr<MaximumWeightRectangleIPModel> _model;
   const Slackmatrix* _slackmatrix;
-  SCIP* _scip;
-  std::vector<SCIP_VAR*> _rowVariables;
-  std::vector<SCIP_VAR*> _columnVariables;
-  std::vector<SCIP_VAR*> _nonzeroVariables;
+  std::vector<double> _feasiblePoint;
+  std::vector<cpm::Rectangle> _rectangles;
+  std::map<std::string, int> _intParams;
+  std::map<std::string, double> _realParams;
+  int _violatedSolutionLimit;
+  double _violationThreshold;
+  std::vector<EscalationStage> _escalationStages;
+  bool _restrictSupport;
+  std::vector<SCIP_VAR*> _fixedVariables;
+  std::atomic<double>* _sharedIncumbent;
+  std::size_t _firstRow;
+  std::size_t _beyondRow;
+};
+
+/**
+ * Partitions the first rows of rectangles into about numBlocks intervals, returned as their boundaries. The lengths of the intervals
+ * grow quadratically, since rectangles are the more numerous the earlier their first row is, so that blocks handed out in order to
+ * concurrent solves keep them busy until the end.
+ */
+
+void partitionFirstRows(std::size_t numRows, std::size_t numBlocks, std::vector<std::size_t>& boundaries);
+
+/**
+ * Exact oracle that partitions the rectangles into blocks of first rows, which are handed out to SCIP oracles with models of their own
+ * on threads of their own as these become idle. The solves share the weight of the heaviest rectangle found so far as an objective
+ * limit, and their rectangles and bounds are merged, so the maximum of their upper bounds is exact.
+ */
+
+class MaximumWeightRectangleParallelIPOracle : public cpm::SeparationOracle
+{
+public:
+  /**
+   * Creates numThreads oracles, which share about 8 blocks of first rows per thread in each call.
+   */
+
+  MaximumWeightRectangleParallelIPOracle(const Slackmatrix& slackmatrix, int priority, std::size_t numThreads);
+
+  virtual ~MaximumWeightRectangleParallelIPOracle();
+
+  inline std::size_t numOracles() const
+  {
+    return _oracles.size();
+  }
+
+  /**
+   * Returns the oracle of a thread, e.g., to set its parameters.
+   */
+
+  inline MaximumWeightRectangleIPOracle& oracle(std::size_t index)
+  {
+    return *_oracles[index];
+  }
+
+  virtual void separate(bool separatePoint, const double* vector, std::vector<double>& lhs, std::vector<double>& rhs,
+    std::vector<std::size_t>& begin, std::vector<std::size_t>& indices, std::vector<double>& values, double& violationLowerBound,
+    double& violationUpperBound);
+
+  virtual bool separateRectangles(const double* vector, std::vector<cpm::Rectangle>& rectangles, double& violationLowerBound,
+    double& violationUpperBound);
+
+  virtual void beginCall();
+
+  virtual void interrupt();
+
+  virtual void getFeasiblePointProperties(bool& scaledDown, bool& scaledUp, std::vector<std::size_t>& modifiableVariables) const;
+
+  virtual std::size_t numFeasiblePoints() const;
+
+  virtual void getFeasiblePoint(std::size_t id, std::vector<double>& point) const;
+
+protected:
+  const Slackmatrix& _slackmatrix;
+  std::vector<std::unique_ptr<MaximumWeightRectangleIPOracle> > _oracles;
+  std::vector<std::size_t> _blockBoundaries;
+  std::atomic<std::size_t> _nextBlock;
+  std::atomic<double> _incumbent;
+  std::vector<cpm::Rectangle> _rectangles;
   std::vector<double> _feasiblePoint;
 };
 
@@ -0,0 +1,147 @@
+#include "separation_trace.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+/* The file starts with this magic number, the numbers of rows, columns and nonzeros and the nonzeros as triples, all as 64-bit
+ * integers. Every point follows as one double per nonzero. */
+
+static const std::uint64_t TRACE_MAGIC = 0x3145434152544e52ULL;
+
+SeparationTraceWriter::SeparationTraceWriter(const std::string& fileName, const Slackmatrix& slackmatrix)
+  : _file(fileName.c_str(), std::ios::binary | std::ios::trunc), _numPoints(0)
+{
+  if (!_file)
+    throw std::runtime_error("SeparationTraceWriter: Cannot open <" + fileName + ">.");
+
+  std::vector<std::uint64_t> header;
+  header.push_back(TRACE_MAGIC);
+  header.push_back(slackmatrix.numRows);
+  header.push_back(slackmatrix.numColumns);
+  header.push_back(slackmatrix.nonzeros.size());
+  for (std::size_t i = 0; i < slackmatrix.nonzeros.size(); ++i)
+  {
+    header.push_back(slackmatrix.nonzeros[i].row);
+    header.push_back(slackmatrix.nonzeros[i].column);
+    header.push_back(slackmatrix.nonzeros[i].slack);
+  }
+  _file.write(reinterpret_cast<const char*>(header.data()), header.size() * sizeof(std::uint64_t));
+  _file.flush();
+  _lastPoint.resize(slackmatrix.nonzeros.size());
+}
+
+SeparationTraceWriter::~SeparationTraceWriter()
+{
+
+}
+
+void SeparationTraceWriter::record(const double* point)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_numPoints > 0 && std::equal(_lastPoint.begin(), _lastPoint.end(), point))
+    return;
+
+  std::copy(point, point + _lastPoint.size(), _lastPoint.begin());
+  _file.write(reinterpret_cast<const char*>(point), _lastPoint.size() * sizeof(double));
+  _file.flush();
+  if (!_file)
+    throw std::runtime_error("SeparationTraceWriter: Cannot write point.");
+  ++_numPoints;
+}
+
+SeparationTraceReader::SeparationTraceReader(const std::string& fileName)
+  : _slackmatrix(NULL)
+{
+  std::ifstream file(fileName.c_str(), std::ios::binary);
+  std::uint64_t header[4];
+  if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != TRACE_MAGIC)
+    throw std::runtime_error("SeparationTraceReader: <" + fileName + "> is not a separation trace.");
+
+  std::vector<std::uint64_t> triples(3 * header[3]);
+  if (!file.read(reinterpret_cast<char*>(triples.data()), triples.size() * sizeof(std::uint64_t)))
+    throw std::runtime_error("SeparationTraceReader: Cannot read matrix from <" + fileName + ">.");
+  std::vector<Slackmatrix::Nonzero> nonzeros(header[3]);
+  for (std::size_t i = 0; i < nonzeros.size(); ++i)
+  {
+    nonzeros[i].row = triples[3 * i];
+    nonzeros[i].column = triples[3 * i + 1];
+    nonzeros[i].slack = triples[3 * i + 2];
+    if (nonzeros[i].row >= header[1] || nonzeros[i].column >= header[2])
+      throw std::runtime_error("SeparationTraceReader: Invalid nonzero in <" + fileName + ">.");
+  }
+  _slackmatrix = new Slackmatrix(header[1], header[2], nonzeros);
+
+  // A truncated last point stems from an interrupted recording and is dropped.
+
+  std::vector<double> point(nonzeros.size());
+  while (file.read(reinterpret_cast<char*>(point.data()), point.size() * sizeof(double)) && !point.empty())
+    _points.push_back(point);
+}
+
+SeparationTraceReader::~SeparationTraceReader()
+{
+  delete _slackmatrix;
+}
+
+RecordingOracle::RecordingOracle(cpm::SeparationOracle* oracle, SeparationTraceWriter* writer)
+  : SeparationOracle(oracle->ambientDimension(), oracle->priority()), _oracle(oracle), _writer(writer)
+{
+
+}
+
+RecordingOracle::~RecordingOracle()
+{
+
+}
+
+void RecordingOracle::separate(bool separatePoint, const double* vector, std::vector<double>& lhs, std::vector<double>& rhs,
+  std::vector<std::size_t>& begin, std::vector<std::size_t>& indices, std::vector<double>& values, double& violationLowerBound,
+  double& violationUpperBound)
+{
+  if (separatePoint)
+    _writer->record(vector);
+  _oracle->separate(separatePoint, vector, lhs, rhs, begin, indices, values, violationLowerBound, violationUpperBound);
+}
+
+bool RecordingOracle::separateRectangles(const double* vector, std::vector<cpm::Rectangle>& rectangles, double& violationLowerBound,
+  double& violationUpperBound)
+{
+  // The oracle may decline, in which case the point is recorded by separate().
+
+  if (!_oracle->separateRectangles(vector, rectangles, violationLowerBound, violationUpperBound))
+    return false;
+  _writer->record(vector);
+  return true;
+}
+
+void RecordingOracle::setRectangleStream(const RectangleStream& stream)
+{
+  _oracle->setRectangleStream(stream);
+}
+
+void RecordingOracle::beginCall()
+{
+  cpm::SeparationOracle::beginCall();
+  _oracle->beginCall();
+}
+
+void RecordingOracle::interrupt()
+{
+  cpm::SeparationOracle::interrupt();
+  _oracle->interrupt();
+}
+
+void RecordingOracle::getFeasiblePointProperties(bool& scaledDown, bool& scaledUp, std::vector<std::size_t>& modifiableVariables) const
+{
+  _oracle->getFeasiblePointProperties(scaledDown, scaledUp, modifiableVariables);
+}
+
+std::size_t RecordingOracle::numFeasiblePoints() const
+{
+  return _oracle->numFeasiblePoints();
+}
+
+void RecordingOracle::getFeasiblePoint(std::size_t id, std::vector<double>& point) const
+{
+  _oracle->getFeasiblePoint(id, point);
+}
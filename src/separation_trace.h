@@ -0,0 +1,107 @@
+#ifndef _SEPARATION_TRACE_H_
+#define _SEPARATION_TRACE_H_
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <cpm/separation_oracle.h>
+
+#include "slackmatrix.h"
+
+/**
+ * Binary file holding a matrix followed by the points passed to its separation oracles. Consecutive duplicate points, such as the
+ * same point being separated by several oracles, are stored once. Recording is thread-safe.
+ */
+
+class SeparationTraceWriter
+{
+public:
+  SeparationTraceWriter(const std::string& fileName, const Slackmatrix& slackmatrix);
+
+  ~SeparationTraceWriter();
+
+  void record(const double* point);
+
+  inline std::size_t numPoints() const
+  {
+    return _numPoints;
+  }
+
+protected:
+  std::ofstream _file;
+  std::vector<double> _lastPoint;
+  std::size_t _numPoints;
+  std::mutex _mutex;
+};
+
+/**
+ * Reads a trace written by SeparationTraceWriter.
+ */
+
+class SeparationTraceReader
+{
+public:
+  SeparationTraceReader(const std::string& fileName);
+
+  ~SeparationTraceReader();
+
+  inline const Slackmatrix& slackmatrix() const
+  {
+    return *_slackmatrix;
+  }
+
+  inline std::size_t numPoints() const
+  {
+    return _points.size();
+  }
+
+  inline const std::vector<double>& point(std::size_t index) const
+  {
+    return _points[index];
+  }
+
+protected:
+  Slackmatrix* _slackmatrix;
+  std::vector<std::vector<double> > _points;
+};
+
+/**
+ * Oracle that records every point it separates to a trace and otherwise forwards all calls to the given oracle, which it does not
+ * own.
+ */
+
+class RecordingOracle : public cpm::SeparationOracle
+{
+public:
+  RecordingOracle(cpm::SeparationOracle* oracle, SeparationTraceWriter* writer);
+
+  virtual ~RecordingOracle();
+
+  virtual void separate(bool separatePoint, const double* vector, std::vector<double>& lhs, std::vector<double>& rhs,
+    std::vector<std::size_t>& begin, std::vector<std::size_t>& indices, std::vector<double>& values, double& violationLowerBound,
+    double& violationUpperBound);
+
+  virtual bool separateRectangles(const double* vector, std::vector<cpm::Rectangle>& rectangles, double& violationLowerBound,
+    double& violationUpperBound);
+
+  virtual void setRectangleStream(const RectangleStream& stream);
+
+  virtual void beginCall();
+
+  virtual void interrupt();
+
+  virtual void getFeasiblePointProperties(bool& scaledDown, bool& scaledUp, std::vector<std::size_t>& modifiableVariables) const;
+
+  virtual std::size_t numFeasiblePoints() const;
+
+  virtual void getFeasiblePoint(std::size_t id, std::vector<double>& point) const;
+
+protected:
+  cpm::SeparationOracle* _oracle;
+  SeparationTraceWriter* _writer;
+};
+
+#endif /* _SEPARATION_TRACE_H_ */
@@ -1,6 +1,11 @@
 #include "slackmatrix.h"
 
+#include <algorithm>
+#include <cassert>
+#include <functional>
 #include <limits>
+#include <stdexcept>
+#include <thread>
 
 Slackmatrix::Slackmatrix(std::size_t nRows, std::size_t nColumns, const std::vector<Nonzero>& nzs)
   : numRows(nRows), numColumns(nColumns), nonzeros(nzs)
@@ -14,9 +19,85 @@ Slackmatrix::Slackmatrix(std::size_t nRows, std::size_t nColumns, const std::vec
   {
     denseIndices[nonzeros[i].row][nonzeros[i].column] = i;
   }
+  rowIdentifiers.resize(nRows);
+  for (std::size_t row = 0; row < nRows; ++row)
+    rowIdentifiers[row] = row;
+  columnIdentifiers.resize(nColumns);
+  for (std::size_t column = 0; column < nColumns; ++column)
+    columnIdentifiers[column] = column;
+}
+
+Slackmatrix::Slackmatrix(std::size_t nRows, std::size_t nColumns, const std::vector<Nonzero>& nzs,
+  const std::vector<std::uint64_t>& rowIds, const std::vector<std::uint64_t>& columnIds)
+  : Slackmatrix(nRows, nColumns, nzs)
+{
+  if (rowIds.size() != nRows || columnIds.size() != nColumns)
+    throw std::runtime_error("Slackmatrix: Number of row or column identifiers does not match the dimensions.");
+  rowIdentifiers = rowIds;
+  columnIdentifiers = columnIds;
+}
+
+Slackmatrix::Slackmatrix(std::size_t nRows, std::size_t nColumns, std::vector<Nonzero>&& nzs, std::size_t numThreads)
+  : numRows(nRows), numColumns(nColumns), nonzeros(std::move(nzs)), denseIndices(nRows)
+{
+  // All rows are allocated before any index is written, since the nonzeros may be in any order. Both phases split their ranges
+  // evenly among the threads.
+
+  numThreads = std::max<std::size_t>(numThreads, 1);
+  auto runParallel = [numThreads](std::size_t size, const std::function<void(std::size_t, std::size_t)>& work)
+  {
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < numThreads; ++t)
+      threads.push_back(std::thread(work, (size * t) / numThreads, (size * (t + 1)) / numThreads));
+    work(0, size / numThreads);
+    for (std::size_t t = 0; t < threads.size(); ++t)
+      threads[t].join();
+  };
+  runParallel(nRows, [this, nColumns](std::size_t begin, std::size_t end)
+    {
+      for (std::size_t row = begin; row < end; ++row)
+        denseIndices[row].resize(nColumns, std::numeric_limits<std::size_t>::max());
+    });
+  runParallel(nonzeros.size(), [this](std::size_t begin, std::size_t end)
+    {
+      for (std::size_t i = begin; i < end; ++i)
+        denseIndices[nonzeros[i].row][nonzeros[i].column] = i;
+    });
+  rowIdentifiers.resize(nRows);
+  for (std::size_t row = 0; row < nRows; ++row)
+    rowIdentifiers[row] = row;
+  columnIdentifiers.resize(nColumns);
+  for (std::size_t column = 0; column < nColumns; ++column)
+    columnIdentifiers[column] = column;
 }
 
 Slackmatrix::~Slackmatrix()
 {
   
-}
\ No newline at end of file
+}
+
+void Slackmatrix::expandRectangle(const cpm::Rectangle& rectangle, std::vector<std::size_t>& indices) const
+{
+  for (std::size_t r = 0; r < rectangle.rows.size(); ++r)
+  {
+    const std::vector<std::size_t>& rowIndices = denseIndices[rectangle.rows[r]];
+    for (std::size_t c = 0; c < rectangle.columns.size(); ++c)
+    {
+      assert(rowIndices[rectangle.columns[c]] != std::numeric_limits<std::size_t>::max());
+      indices.push_back(rowIndices[rectangle.columns[c]]);
+    }
+  }
+}
+
+void Slackmatrix::appendInequalities(const std::vector<cpm::Rectangle>& rectangles, std::vector<double>& lhs, std::vector<double>& rhs,
+  std::vector<std::size_t>& begin, std::vector<std::size_t>& indices, std::vector<double>& values) const
+{
+  for (std::size_t i = 0; i < rectangles.size(); ++i)
+  {
+    lhs.push_back(-std::numeric_limits<double>::infinity());
+    rhs.push_back(1.0);
+    begin.push_back(indices.size());
+    expandRectangle(rectangles[i], indices);
+  }
+  values.resize(indices.size(), 1.0);
+}
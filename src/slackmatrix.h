@@ -2,6 +2,9 @@
 #define _SLACKMATRIX_H_
 
 #include <vector>
+#include <cstdint>
+
+#include <cpm/rectangle.h>
 
 class Slackmatrix
 {
@@ -18,8 +21,37 @@ public:
   std::vector<Nonzero> nonzeros;
   std::vector<std::vector<std::size_t> > denseIndices;
 
+  /**
+   * Persistent identifiers of rows and columns that stay valid across related matrices. They default to the indices.
+   */
+
+  std::vector<std::uint64_t> rowIdentifiers;
+  std::vector<std::uint64_t> columnIdentifiers;
+
   Slackmatrix(std::size_t numRows, std::size_t numColumns, const std::vector<Nonzero>& nonzeros);
+  Slackmatrix(std::size_t numRows, std::size_t numColumns, const std::vector<Nonzero>& nonzeros,
+    const std::vector<std::uint64_t>& rowIdentifiers, const std::vector<std::uint64_t>& columnIdentifiers);
+
+  /**
+   * Takes over the nonzeros and fills the dense index table on numThreads threads.
+   */
+
+  Slackmatrix(std::size_t numRows, std::size_t numColumns, std::vector<Nonzero>&& nonzeros, std::size_t numThreads);
+
   ~Slackmatrix();
+
+  /**
+   * Appends the indices of the nonzeros of a rectangle, which must not contain zero entries.
+   */
+
+  void expandRectangle(const cpm::Rectangle& rectangle, std::vector<std::size_t>& indices) const;
+
+  /**
+   * Appends the inequalities x(R) <= 1 of the given rectangles in CSR format.
+   */
+
+  void appendInequalities(const std::vector<cpm::Rectangle>& rectangles, std::vector<double>& lhs, std::vector<double>& rhs,
+    std::vector<std::size_t>& begin, std::vector<std::size_t>& indices, std::vector<double>& values) const;
 };
 
 #endif /* _SLACKMATRIX_H_ */
\ No newline at end of file
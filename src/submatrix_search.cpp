@@ -0,0 +1,272 @@
+#include "submatrix_search.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#include "decomposition.h"
+
+SubmatrixSearchOptions::SubmatrixSearchOptions()
+  : numRows(20), numColumns(20), selection("weight"), maxSubmatrices(0), timeLimit(std::numeric_limits<double>::infinity()),
+  numThreads(1)
+{
+
+}
+
+/* Shared state of all search threads. */
+
+struct SubmatrixSearch
+{
+  const Slackmatrix& slackmatrix;
+  const SubmatrixSearchOptions& options;
+  std::vector<std::vector<std::size_t> > rowColumns;
+  std::vector<std::vector<std::size_t> > columnRows;
+  std::discrete_distribution<std::size_t> heavyNonzero;
+  std::mutex mutex;
+  std::vector<std::pair<std::vector<std::size_t>, std::vector<std::size_t> > > rectangles;
+  double bestBound;
+  std::size_t numSolved;
+
+  SubmatrixSearch(const Slackmatrix& slackmatrix, const SubmatrixSearchOptions& options);
+
+  void selectRandom(std::mt19937& random, std::vector<std::size_t>& rows, std::vector<std::size_t>& columns) const;
+
+  void grow(std::vector<std::size_t>& rows, std::vector<std::size_t>& columns) const;
+};
+
+SubmatrixSearch::SubmatrixSearch(const Slackmatrix& matrix, const SubmatrixSearchOptions& opts)
+  : slackmatrix(matrix), options(opts), rowColumns(matrix.numRows), columnRows(matrix.numColumns), bestBound(0.0), numSolved(0)
+{
+  std::vector<double> weights(slackmatrix.nonzeros.size());
+  for (std::size_t i = 0; i < slackmatrix.nonzeros.size(); ++i)
+  {
+    const Slackmatrix::Nonzero& nonzero = slackmatrix.nonzeros[i];
+    rowColumns[nonzero.row].push_back(nonzero.column);
+    columnRows[nonzero.column].push_back(nonzero.row);
+    weights[i] = nonzero.slack;
+  }
+  heavyNonzero = std::discrete_distribution<std::size_t>(weights.begin(), weights.end());
+}
+
+void SubmatrixSearch::selectRandom(std::mt19937& random, std::vector<std::size_t>& rows, std::vector<std::size_t>& columns) const
+{
+  rows.resize(slackmatrix.numRows);
+  for (std::size_t r = 0; r < rows.size(); ++r)
+    rows[r] = r;
+  std::shuffle(rows.begin(), rows.end(), random);
+  rows.resize(std::min(options.numRows, rows.size()));
+  columns.resize(slackmatrix.numColumns);
+  for (std::size_t c = 0; c < columns.size(); ++c)
+    columns[c] = c;
+  std::shuffle(columns.begin(), columns.end(), random);
+  columns.resize(std::min(options.numColumns, columns.size()));
+}
+
+void SubmatrixSearch::grow(std::vector<std::size_t>& rows, std::vector<std::size_t>& columns) const
+{
+  // Gains are the total slack of a row (column) within the selected columns (rows) and are updated whenever a line is added.
+
+  std::vector<double> rowGain(slackmatrix.numRows, 0.0);
+  std::vector<double> columnGain(slackmatrix.numColumns, 0.0);
+  std::vector<bool> rowSelected(slackmatrix.numRows, false);
+  std::vector<bool> columnSelected(slackmatrix.numColumns, false);
+  for (std::size_t i = 0; i < rows.size(); ++i)
+  {
+    rowSelected[rows[i]] = true;
+    for (std::size_t j = 0; j < rowColumns[rows[i]].size(); ++j)
+      columnGain[rowColumns[rows[i]][j]] += slackmatrix.nonzeros[slackmatrix.denseIndices[rows[i]][rowColumns[rows[i]][j]]].slack;
+  }
+  for (std::size_t i = 0; i < columns.size(); ++i)
+  {
+    columnSelected[columns[i]] = true;
+    for (std::size_t j = 0; j < columnRows[columns[i]].size(); ++j)
+      rowGain[columnRows[columns[i]][j]] += slackmatrix.nonzeros[slackmatrix.denseIndices[columnRows[columns[i]][j]][columns[i]]].slack;
+  }
+
+  std::size_t numRows = std::min(options.numRows, slackmatrix.numRows);
+  std::size_t numColumns = std::min(options.numColumns, slackmatrix.numColumns);
+  while (rows.size() < numRows || columns.size() < numColumns)
+  {
+    bool addRow = columns.size() >= numColumns || (rows.size() < numRows && rows.size() * numColumns <= columns.size() * numRows);
+    if (addRow)
+    {
+      std::size_t best = std::max_element(rowGain.begin(), rowGain.end()) - rowGain.begin();
+      if (rowGain[best] <= 0.0)
+        break;
+
+      rows.push_back(best);
+      rowSelected[best] = true;
+      rowGain[best] = -1.0;
+      for (std::size_t j = 0; j < rowColumns[best].size(); ++j)
+      {
+        std::size_t column = rowColumns[best][j];
+        if (!columnSelected[column])
+          columnGain[column] += slackmatrix.nonzeros[slackmatrix.denseIndices[best][column]].slack;
+      }
+    }
+    else
+    {
+      std::size_t best = std::max_element(columnGain.begin(), columnGain.end()) - columnGain.begin();
+      if (columnGain[best] <= 0.0)
+        break;
+
+      columns.push_back(best);
+      columnSelected[best] = true;
+      columnGain[best] = -1.0;
+      for (std::size_t j = 0; j < columnRows[best].size(); ++j)
+      {
+        std::size_t row = columnRows[best][j];
+        if (!rowSelected[row])
+          rowGain[row] += slackmatrix.nonzeros[slackmatrix.denseIndices[row][best]].slack;
+      }
+    }
+  }
+}
+
+double searchSubmatrixBounds(const Slackmatrix& slackmatrix, const BoundOptions& options, const SubmatrixSearchOptions& searchOptions,
+  const SubmatrixBoundCallback& callback, const std::atomic<bool>* stop)
+{
+  if (searchOptions.selection != "random" && searchOptions.selection != "weight" && searchOptions.selection != "violated")
+    throw std::runtime_error("Unknown submatrix selection <" + searchOptions.selection + ">.");
+  if (slackmatrix.nonzeros.empty())
+    throw std::runtime_error("Matrix is the zero matrix.");
+
+  std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+  std::size_t maxEntry = 0;
+  for (std::size_t i = 0; i < slackmatrix.nonzeros.size(); ++i)
+    maxEntry = std::max(maxEntry, slackmatrix.nonzeros[i].slack);
+
+  BoundOptions lpOptions = options;
+  lpOptions.decompose = false;
+  lpOptions.reorder = "none";
+  lpOptions.numThreads = 1;
+  lpOptions.verbose = false;
+  lpOptions.storeCuts = searchOptions.selection == "violated";
+  lpOptions.rectangleLibrary.clear();
+  lpOptions.progressCallback = BoundProgressCallback();
+
+  SubmatrixSearch search(slackmatrix, searchOptions);
+  std::atomic<std::size_t> numStarted(0);
+  std::mutex exceptionMutex;
+  std::exception_ptr exception;
+  auto elapsedTime = [&timeStart]()
+  {
+    return std::chrono::duration_cast<std::chrono::duration<double> >(std::chrono::steady_clock::now() - timeStart).count();
+  };
+  auto worker = [&](std::size_t thread)
+  {
+    std::mt19937 random(thread);
+    std::discrete_distribution<std::size_t> heavyNonzero = search.heavyNonzero;
+    std::vector<std::size_t> rows, columns;
+    while (!(stop != NULL && *stop) && elapsedTime() < searchOptions.timeLimit
+      && (searchOptions.maxSubmatrices == 0 || numStarted++ < searchOptions.maxSubmatrices))
+    {
+      try
+      {
+        // Select rows and columns.
+
+        rows.clear();
+        columns.clear();
+        if (searchOptions.selection == "random")
+          search.selectRandom(random, rows, columns);
+        else
+        {
+          std::lock_guard<std::mutex> lock(search.mutex);
+          if (searchOptions.selection == "violated" && !search.rectangles.empty())
+          {
+            std::size_t r = std::uniform_int_distribution<std::size_t>(0, search.rectangles.size() - 1)(random);
+            rows = search.rectangles[r].first;
+            columns = search.rectangles[r].second;
+          }
+        }
+        if (searchOptions.selection != "random")
+        {
+          if (rows.empty())
+          {
+            const Slackmatrix::Nonzero& seed = slackmatrix.nonzeros[heavyNonzero(random)];
+            rows.push_back(seed.row);
+            columns.push_back(seed.column);
+          }
+          search.grow(rows, columns);
+        }
+        std::sort(rows.begin(), rows.end());
+        std::sort(columns.begin(), columns.end());
+
+        SlackmatrixComponent component;
+        component.rows = rows;
+        component.columns = columns;
+        std::size_t componentMaxEntry = 0;
+        for (std::size_t r = 0; r < rows.size(); ++r)
+        {
+          for (std::size_t c = 0; c < columns.size(); ++c)
+          {
+            std::size_t nonzero = slackmatrix.denseIndices[rows[r]][columns[c]];
+            if (nonzero == std::numeric_limits<std::size_t>::max())
+              continue;
+
+            component.nonzeros.push_back(nonzero);
+            componentMaxEntry = std::max(componentMaxEntry, slackmatrix.nonzeros[nonzero].slack);
+          }
+        }
+        if (component.nonzeros.empty())
+          continue;
+
+        // Solve the LP of the submatrix and rescale its primal bound to the whole matrix.
+
+        BoundResult result = computeBound(extractComponent(slackmatrix, component), lpOptions);
+        double bound = result.primalBound * componentMaxEntry / maxEntry;
+
+        std::lock_guard<std::mutex> lock(search.mutex);
+        ++search.numSolved;
+        if (bound > search.bestBound)
+        {
+          search.bestBound = bound;
+          for (std::size_t i = 0; i < result.cuts.size() && search.rectangles.size() < 1000; ++i)
+          {
+            std::vector<std::size_t> cutRows, cutColumns;
+            for (std::size_t j = 0; j < result.cuts[i].size(); ++j)
+            {
+              const Slackmatrix::Nonzero& nonzero = slackmatrix.nonzeros[component.nonzeros[result.cuts[i][j]]];
+              cutRows.push_back(nonzero.row);
+              cutColumns.push_back(nonzero.column);
+            }
+            std::sort(cutRows.begin(), cutRows.end());
+            cutRows.erase(std::unique(cutRows.begin(), cutRows.end()), cutRows.end());
+            std::sort(cutColumns.begin(), cutColumns.end());
+            cutColumns.erase(std::unique(cutColumns.begin(), cutColumns.end()), cutColumns.end());
+            search.rectangles.push_back(std::make_pair(cutRows, cutColumns));
+          }
+
+          if (callback)
+          {
+            SubmatrixBound improvement = { bound, elapsedTime(), search.numSolved, rows, columns };
+            callback(improvement);
+          }
+        }
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(exceptionMutex);
+        if (!exception)
+          exception = std::current_exception();
+        return;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t t = 1; t < searchOptions.numThreads; ++t)
+    threads.push_back(std::thread(worker, t));
+  worker(0);
+  for (std::size_t t = 0; t < threads.size(); ++t)
+    threads[t].join();
+  if (exception)
+    std::rethrow_exception(exception);
+
+  return search.bestBound;
+}
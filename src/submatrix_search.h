@@ -0,0 +1,55 @@
+#ifndef _SUBMATRIX_SEARCH_H_
+#define _SUBMATRIX_SEARCH_H_
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "bounds.h"
+#include "slackmatrix.h"
+
+/**
+ * Improved bound found by the submatrix search, scaled like the LP of the whole matrix.
+ */
+
+struct SubmatrixBound
+{
+  double bound;
+  double time;
+  std::size_t numSolved;
+  std::vector<std::size_t> rows;
+  std::vector<std::size_t> columns;
+};
+
+typedef std::function<void(const SubmatrixBound&)> SubmatrixBoundCallback;
+
+struct SubmatrixSearchOptions
+{
+  std::size_t numRows;
+  std::size_t numColumns;
+
+  /**
+   * One of "random", "weight" (grown greedily from a heavy entry) and "violated" (grown around rectangles generated by the best
+   * submatrix LPs so far).
+   */
+
+  std::string selection;
+  std::size_t maxSubmatrices;
+  double timeLimit;
+  std::size_t numThreads;
+
+  SubmatrixSearchOptions();
+};
+
+/**
+ * Solves the LPs of many small submatrices in parallel. The primal bound of every submatrix LP is a valid lower bound for the whole
+ * matrix, so the best one is returned, and each improvement is reported via the callback, which may be called from any search
+ * thread. The search ends after maxSubmatrices LPs (0 for no limit), after timeLimit seconds, or once stop is set. The LPs are
+ * solved with options, except that they run single-threaded and quietly.
+ */
+
+double searchSubmatrixBounds(const Slackmatrix& slackmatrix, const BoundOptions& options, const SubmatrixSearchOptions& searchOptions,
+  const SubmatrixBoundCallback& callback, const std::atomic<bool>* stop = NULL);
+
+#endif /* _SUBMATRIX_SEARCH_H_ */
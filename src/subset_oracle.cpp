@@ -0,0 +1,283 @@
+#include "subset_oracle.h"
+
+#include <cassert>
+#include <limits>
+#include <algorithm>
+#include <thread>
+
+MaximumWeightRectangleSubsetOracle::MaximumWeightRectangleSubsetOracle(const Slackmatrix& slackmatrix, int priority,
+  std::size_t maxSubsetSize, std::size_t exactLimit, std::size_t maxCuts)
+  : SeparationOracle(slackmatrix.nonzeros.size(), priority), _maxSubsetSize(maxSubsetSize), _maxCuts(std::max<std::size_t>(maxCuts, 1)),
+  _numThreads(1), _vector(NULL), _nextSubproblem(0), _sharedThreshold(1.0), _bound(slackmatrix)
+{
+  // Lines are the elements of the shorter side, crosses those of the other side.
+
+  _transposed = slackmatrix.numRows > slackmatrix.numColumns;
+  std::size_t numLines = _transposed ? slackmatrix.numColumns : slackmatrix.numRows;
+  _numCrosses = _transposed ? slackmatrix.numRows : slackmatrix.numColumns;
+  _lines.resize(numLines);
+  for (std::size_t l = 0; l < numLines; ++l)
+  {
+    for (std::size_t x = 0; x < _numCrosses; ++x)
+    {
+      std::size_t v = _transposed ? slackmatrix.denseIndices[x][l] : slackmatrix.denseIndices[l][x];
+      if (v == std::numeric_limits<std::size_t>::max())
+        continue;
+
+      Entry entry = { x, v };
+      _lines[l].push_back(entry);
+    }
+  }
+
+  // Dense map from line and cross to variable for the incremental intersection.
+
+  _variableIndex.resize(numLines);
+  for (std::size_t l = 0; l < numLines; ++l)
+  {
+    _variableIndex[l].assign(_numCrosses, std::numeric_limits<std::size_t>::max());
+    for (std::size_t i = 0; i < _lines[l].size(); ++i)
+      _variableIndex[l][_lines[l][i].cross] = _lines[l][i].variable;
+  }
+
+  if (numLines <= exactLimit)
+    _maxSubsetSize = numLines;
+  _maxSubsetSize = std::min(_maxSubsetSize, numLines);
+
+  _suffixPositive.resize(numLines + 1, std::vector<double>(_numCrosses, 0.0));
+  setNumThreads(1);
+}
+
+MaximumWeightRectangleSubsetOracle::~MaximumWeightRectangleSubsetOracle()
+{
+
+}
+
+void MaximumWeightRectangleSubsetOracle::setNumThreads(std::size_t numThreads)
+{
+  _numThreads = std::max<std::size_t>(std::min(numThreads, _lines.size()), 1);
+  _states.resize(_numThreads);
+  for (std::size_t t = 0; t < _numThreads; ++t)
+  {
+    _states[t].subset.reserve(_maxSubsetSize);
+    _states[t].intersection.resize(_maxSubsetSize + 1);
+    _states[t].crossSum.resize(_maxSubsetSize + 1);
+  }
+}
+
+void MaximumWeightRectangleSubsetOracle::separate(bool separatePoint, const double* vector, std::vector<double>& lhs,
+  std::vector<double>& rhs, std::vector<std::size_t>& begin, std::vector<std::size_t>& indices, std::vector<double>& values,
+  double& violationLowerBound, double& violationUpperBound)
+{
+  assert(separatePoint);
+
+  _rectangles.clear();
+  separateRectangles(vector, _rectangles, violationLowerBound, violationUpperBound);
+  for (std::size_t i = 0; i < _rectangles.size(); ++i)
+  {
+    const std::vector<std::uint32_t>& lines = _transposed ? _rectangles[i].columns : _rectangles[i].rows;
+    const std::vector<std::uint32_t>& crosses = _transposed ? _rectangles[i].rows : _rectangles[i].columns;
+    lhs.push_back(-std::numeric_limits<double>::infinity());
+    rhs.push_back(1.0);
+    begin.push_back(indices.size());
+    for (std::size_t l = 0; l < lines.size(); ++l)
+    {
+      for (std::size_t x = 0; x < crosses.size(); ++x)
+      {
+        indices.push_back(_variableIndex[lines[l]][crosses[x]]);
+        values.push_back(1.0);
+      }
+    }
+  }
+}
+
+bool MaximumWeightRectangleSubsetOracle::separateRectangles(const double* vector, std::vector<cpm::Rectangle>& rectangles,
+  double& violationLowerBound, double& violationUpperBound)
+{
+  // Positive mass of lines l, ..., k-1 per cross, which bounds what any extension of a subset can still add.
+
+  std::size_t numLines = _lines.size();
+  std::fill(_suffixPositive[numLines].begin(), _suffixPositive[numLines].end(), 0.0);
+  for (std::size_t l = numLines; l > 0; --l)
+  {
+    _suffixPositive[l - 1] = _suffixPositive[l];
+    for (std::size_t i = 0; i < _lines[l - 1].size(); ++i)
+      _suffixPositive[l - 1][_lines[l - 1][i].cross] += std::max(vector[_lines[l - 1][i].variable], 0.0);
+  }
+
+  _vector = vector;
+  _nextSubproblem = 0;
+  _sharedThreshold = 1.0;
+  for (std::size_t t = 0; t < _numThreads; ++t)
+  {
+    SearchState& state = _states[t];
+    state.subset.clear();
+    state.candidates.clear();
+    state.bestWeight = 0.0;
+    state.intersection[0].clear();
+    state.crossSum[0].clear();
+    for (std::size_t x = 0; x < _numCrosses; ++x)
+    {
+      state.intersection[0].push_back(x);
+      state.crossSum[0].push_back(0.0);
+    }
+  }
+  if (_maxSubsetSize > 0)
+  {
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < _numThreads; ++t)
+      threads.push_back(std::thread(&MaximumWeightRectangleSubsetOracle::searchSubproblems, this, std::ref(_states[t])));
+    searchSubproblems(_states[0]);
+    for (std::size_t t = 0; t < threads.size(); ++t)
+      threads[t].join();
+  }
+
+  // Merge the candidates of all threads and emit the heaviest rectangles, each with the crosses of positive sum.
+
+  std::vector<Candidate> candidates;
+  double bestWeight = 0.0;
+  for (std::size_t t = 0; t < _numThreads; ++t)
+  {
+    candidates.insert(candidates.end(), _states[t].candidates.begin(), _states[t].candidates.end());
+    bestWeight = std::max(bestWeight, _states[t].bestWeight);
+  }
+  std::sort(candidates.begin(), candidates.end());
+  if (candidates.size() > _maxCuts)
+    candidates.resize(_maxCuts);
+  for (std::size_t c = 0; c < candidates.size(); ++c)
+  {
+    const Candidate& candidate = candidates[c];
+    double violation = candidate.weight - 1.0;
+    if (violation <= 1.0e-3)
+      continue;
+
+    rectangles.push_back(cpm::Rectangle());
+    std::vector<std::uint32_t>& lines = _transposed ? rectangles.back().columns : rectangles.back().rows;
+    std::vector<std::uint32_t>& crosses = _transposed ? rectangles.back().rows : rectangles.back().columns;
+    lines.assign(candidate.lines.begin(), candidate.lines.end());
+    crosses.assign(candidate.crosses.begin(), candidate.crosses.end());
+    if (violation > violationLowerBound)
+      violationLowerBound = violation;
+  }
+
+  // Subtrees were only pruned if they could not exceed weight 1 or the best weight found, so complete enumeration is exact. Otherwise,
+  // a certified bound on the maximum rectangle weight is used. A tighter bound of an oracle called before in the same round is kept.
+
+  double maxWeight = std::max(isExact() ? bestWeight : _bound.crossBound(vector, 4 * ambientDimension()), 1.0);
+  violationUpperBound = std::min(violationUpperBound, maxWeight - 1.0);
+  _feasiblePoint.resize(ambientDimension());
+  for (std::size_t v = 0; v < ambientDimension(); ++v)
+    _feasiblePoint[v] = vector[v] / maxWeight;
+
+  return true;
+}
+
+void MaximumWeightRectangleSubsetOracle::searchSubproblems(SearchState& state)
+{
+  // Subproblem l consists of the subsets whose smallest line is l. Early lines have the largest subproblems and are taken first.
+
+  for (std::size_t l = _nextSubproblem++; l < _lines.size(); l = _nextSubproblem++)
+    search(state, 0, l, l + 1);
+}
+
+void MaximumWeightRectangleSubsetOracle::search(SearchState& state, std::size_t depth, std::size_t start, std::size_t beyond)
+{
+  const std::vector<std::size_t>& intersection = state.intersection[depth];
+  const std::vector<double>& crossSum = state.crossSum[depth];
+  std::vector<std::size_t>& nextIntersection = state.intersection[depth + 1];
+  std::vector<double>& nextCrossSum = state.crossSum[depth + 1];
+
+  for (std::size_t l = start; l < beyond; ++l)
+  {
+    // Add line l to the subset, restricting the intersection to the crosses it covers.
+
+    const std::vector<std::size_t>& variableIndex = _variableIndex[l];
+    nextIntersection.clear();
+    nextCrossSum.clear();
+    double weight = 0.0;
+    double bound = 0.0;
+    for (std::size_t i = 0; i < intersection.size(); ++i)
+    {
+      std::size_t x = intersection[i];
+      std::size_t v = variableIndex[x];
+      if (v == std::numeric_limits<std::size_t>::max())
+        continue;
+
+      double sum = crossSum[i] + _vector[v];
+      nextIntersection.push_back(x);
+      nextCrossSum.push_back(sum);
+      weight += std::max(sum, 0.0);
+      bound += std::max(sum + _suffixPositive[l + 1][x], 0.0);
+    }
+    if (nextIntersection.empty())
+      continue;
+
+    state.subset.push_back(l);
+    if (weight > state.bestWeight)
+      state.bestWeight = weight;
+    if (weight > threshold(state))
+      record(state, depth + 1, weight);
+
+    // Descend unless no extension can beat the threshold, then remove line l again.
+
+    if (depth + 1 < _maxSubsetSize && bound > threshold(state))
+      search(state, depth + 1, l + 1, _lines.size());
+    state.subset.pop_back();
+  }
+}
+
+double MaximumWeightRectangleSubsetOracle::threshold(const SearchState& state) const
+{
+  // Once a thread holds maxCuts candidates, the lightest of them bounds the weight of the overall maxCuts-th heaviest from below.
+
+  double ownThreshold = state.candidates.size() < _maxCuts ? 1.0 : std::max(state.candidates.front().weight, 1.0);
+  return std::max(ownThreshold, _sharedThreshold.load(std::memory_order_relaxed));
+}
+
+void MaximumWeightRectangleSubsetOracle::record(SearchState& state, std::size_t depth, double weight)
+{
+  // The candidates form a min-heap by weight.
+
+  if (state.candidates.size() == _maxCuts)
+  {
+    std::pop_heap(state.candidates.begin(), state.candidates.end());
+    state.candidates.pop_back();
+  }
+
+  Candidate candidate;
+  candidate.weight = weight;
+  candidate.lines = state.subset;
+  for (std::size_t i = 0; i < state.intersection[depth].size(); ++i)
+  {
+    if (state.crossSum[depth][i] > 0.0)
+      candidate.crosses.push_back(state.intersection[depth][i]);
+  }
+  state.candidates.push_back(candidate);
+  std::push_heap(state.candidates.begin(), state.candidates.end());
+
+  if (state.candidates.size() == _maxCuts)
+  {
+    double newThreshold = state.candidates.front().weight;
+    double oldThreshold = _sharedThreshold.load(std::memory_order_relaxed);
+    while (newThreshold > oldThreshold && !_sharedThreshold.compare_exchange_weak(oldThreshold, newThreshold))
+      ;
+  }
+}
+
+void MaximumWeightRectangleSubsetOracle::getFeasiblePointProperties(bool& scaledDown, bool& scaledUp,
+  std::vector<std::size_t>& modifiableVariables) const
+{
+  cpm::SeparationOracle::getFeasiblePointProperties(scaledDown, scaledUp, modifiableVariables);
+  scaledDown = true;
+}
+
+std::size_t MaximumWeightRectangleSubsetOracle::numFeasiblePoints() const
+{
+  return _feasiblePoint.empty() ? 0 : 1;
+}
+
+void MaximumWeightRectangleSubsetOracle::getFeasiblePoint(std::size_t id, std::vector<double>& point) const
+{
+  assert(id == 0);
+  assert(!_feasiblePoint.empty());
+  point = _feasiblePoint;
+}
@@ -0,0 +1,108 @@
+#ifndef _SUBSET_ORACLE_H_
+#define _SUBSET_ORACLE_H_
+
+#include <atomic>
+
+#include <cpm/separation_oracle.h>
+
+#include "slackmatrix.h"
+#include "weight_bound.h"
+
+/**
+ * Enumerates subsets of the shorter side of the matrix (rows or columns) by depth-first search over combinations, in which every
+ * subset extends its parent by a single line. Column sums and the support intersection of each level are kept on a stack, so adding a
+ * line costs time linear in the intersection and backtracking is free, and subtrees are pruned by the optimistic weight of the
+ * remaining lines. A Gray-code order is not used since it has no subtrees to prune, and removing a line would require per-cross
+ * counters to restore the intersection. The oracle is exact if all subsets are enumerated, i.e., if the shorter side has at most
+ * exactLimit elements, and a heuristic restricted to subsets of size maxSubsetSize otherwise.
+ *
+ * The subsets with a common smallest line form independent subproblems, which can be searched by several threads. These share the
+ * weight that a rectangle must exceed to be among the heaviest ones found, so that each thread prunes by the others' findings.
+ *
+ * Every call yields a feasible point by scaling, using the heaviest rectangle if the oracle is exact and a cheap certified bound on the
+ * maximum rectangle weight otherwise.
+ */
+
+class MaximumWeightRectangleSubsetOracle : public cpm::SeparationOracle
+{
+public:
+  MaximumWeightRectangleSubsetOracle(const Slackmatrix& slackmatrix, int priority, std::size_t maxSubsetSize = 3,
+    std::size_t exactLimit = 24, std::size_t maxCuts = 10);
+
+  virtual ~MaximumWeightRectangleSubsetOracle();
+
+  virtual void separate(bool separatePoint, const double* vector, std::vector<double>& lhs, std::vector<double>& rhs,
+    std::vector<std::size_t>& begin, std::vector<std::size_t>& indices, std::vector<double>& values, double& violationLowerBound,
+    double& violationUpperBound);
+
+  virtual bool separateRectangles(const double* vector, std::vector<cpm::Rectangle>& rectangles, double& violationLowerBound,
+    double& violationUpperBound);
+
+  virtual void getFeasiblePointProperties(bool& scaledDown, bool& scaledUp, std::vector< std::size_t >& modifiableVariables) const;
+
+  virtual std::size_t numFeasiblePoints() const;
+
+  virtual void getFeasiblePoint(std::size_t id, std::vector<double>& point) const;
+
+  inline bool isExact() const
+  {
+    return _maxSubsetSize >= _lines.size();
+  }
+
+  void setNumThreads(std::size_t numThreads);
+
+protected:
+  struct Entry
+  {
+    std::size_t cross;
+    std::size_t variable;
+  };
+
+  struct Candidate
+  {
+    double weight;
+    std::vector<std::size_t> lines;
+    std::vector<std::size_t> crosses;
+
+    inline bool operator<(const Candidate& other) const
+    {
+      return weight > other.weight;
+    }
+  };
+
+  struct SearchState
+  {
+    std::vector<std::size_t> subset;
+    std::vector<std::vector<std::size_t> > intersection;
+    std::vector<std::vector<double> > crossSum;
+    std::vector<Candidate> candidates;
+    double bestWeight;
+  };
+
+  void searchSubproblems(SearchState& state);
+
+  void search(SearchState& state, std::size_t depth, std::size_t start, std::size_t beyond);
+
+  double threshold(const SearchState& state) const;
+
+  void record(SearchState& state, std::size_t depth, double weight);
+
+  bool _transposed;
+  std::vector<std::vector<Entry> > _lines;
+  std::vector<std::vector<std::size_t> > _variableIndex;
+  std::size_t _numCrosses;
+  std::size_t _maxSubsetSize;
+  std::size_t _maxCuts;
+  std::size_t _numThreads;
+
+  const double* _vector;
+  std::vector<std::vector<double> > _suffixPositive;
+  std::vector<SearchState> _states;
+  std::atomic<std::size_t> _nextSubproblem;
+  std::atomic<double> _sharedThreshold;
+  MaximumWeightRectangleBound _bound;
+  std::vector<double> _feasiblePoint;
+  std::vector<cpm::Rectangle> _rectangles;
+};
+
+#endif /* _SUBSET_ORACLE_H_ */
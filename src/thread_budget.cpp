@@ -0,0 +1,40 @@
+#include "thread_budget.h"
+
+#include <algorithm>
+
+ThreadBudget::ThreadBudget(std::size_t numAvailable)
+  : _numAvailable(numAvailable)
+{
+
+}
+
+ThreadBudget::~ThreadBudget()
+{
+
+}
+
+std::size_t ThreadBudget::acquire(std::size_t count)
+{
+  std::size_t available = _numAvailable.load();
+  std::size_t granted = std::min(count, available);
+  while (granted > 0 && !_numAvailable.compare_exchange_weak(available, available - granted))
+    granted = std::min(count, available);
+  return granted;
+}
+
+void ThreadBudget::release(std::size_t count)
+{
+  _numAvailable += count;
+}
+
+ThreadReservation::ThreadReservation(ThreadBudget* budget, std::size_t numAdditional)
+  : _budget(budget), _numAdditional(budget != NULL ? budget->acquire(numAdditional) : numAdditional)
+{
+
+}
+
+ThreadReservation::~ThreadReservation()
+{
+  if (_budget != NULL)
+    _budget->release(_numAdditional);
+}
@@ -0,0 +1,57 @@
+#ifndef _THREAD_BUDGET_H_
+#define _THREAD_BUDGET_H_
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * Number of threads that may still be started, shared by nested parallel code such that the total stays within one limit. Every
+ * running thread holds one unit implicitly, and code that wants to use more threads acquires additional ones and releases them again.
+ * All methods are thread-safe.
+ */
+
+class ThreadBudget
+{
+public:
+  ThreadBudget(std::size_t numAvailable);
+
+  ~ThreadBudget();
+
+  /**
+   * Acquires up to count threads and returns how many were granted.
+   */
+
+  std::size_t acquire(std::size_t count);
+
+  void release(std::size_t count);
+
+protected:
+  std::atomic<std::size_t> _numAvailable;
+};
+
+/**
+ * Holds additional threads of a budget until it is destroyed. Without a budget, all requested threads are granted.
+ */
+
+class ThreadReservation
+{
+public:
+  ThreadReservation(ThreadBudget* budget, std::size_t numAdditional);
+
+  ~ThreadReservation();
+
+  /**
+   * Returns the number of threads that may be used, including the calling one.
+   */
+
+  inline std::size_t numThreads() const
+  {
+    return _numAdditional + 1;
+  }
+
+protected:
+  ThreadBudget* _budget;
+  std::size_t _numAdditional;
+};
+
+#endif /* _THREAD_BUDGET_H_ */
@@ -0,0 +1,124 @@
+#include "weight_bound.h"
+
+#include <algorithm>
+#include <functional>
+
+MaximumWeightRectangleBound::MaximumWeightRectangleBound(const Slackmatrix& slackmatrix)
+  : _rowEntries(slackmatrix.numRows), _columnEntries(slackmatrix.numColumns), _positiveByRow(slackmatrix.numRows),
+  _positiveByColumn(slackmatrix.numColumns), _rowBound(slackmatrix.numRows), _columnBound(slackmatrix.numColumns),
+  _columnMarks(slackmatrix.numColumns, 0), _currentMark(0)
+{
+  _rows.resize(slackmatrix.nonzeros.size());
+  _columns.resize(slackmatrix.nonzeros.size());
+  for (std::size_t i = 0; i < slackmatrix.nonzeros.size(); ++i)
+  {
+    _rows[i] = slackmatrix.nonzeros[i].row;
+    _columns[i] = slackmatrix.nonzeros[i].column;
+    _rowEntries[_rows[i]].push_back(i);
+    _columnEntries[_columns[i]].push_back(i);
+  }
+
+  // Evaluating the cross of a column's entry scans the rows of that column.
+
+  _crossSize.assign(slackmatrix.numColumns, 0);
+  for (std::size_t c = 0; c < slackmatrix.numColumns; ++c)
+  {
+    for (std::size_t j = 0; j < _columnEntries[c].size(); ++j)
+      _crossSize[c] += _rowEntries[_rows[_columnEntries[c][j]]].size();
+  }
+}
+
+MaximumWeightRectangleBound::~MaximumWeightRectangleBound()
+{
+
+}
+
+double MaximumWeightRectangleBound::lineBound(const double* vector)
+{
+  std::fill(_positiveByRow.begin(), _positiveByRow.end(), 0.0);
+  std::fill(_positiveByColumn.begin(), _positiveByColumn.end(), 0.0);
+  for (std::size_t i = 0; i < _rows.size(); ++i)
+  {
+    if (vector[i] > 0.0)
+    {
+      _positiveByRow[_rows[i]] += vector[i];
+      _positiveByColumn[_columns[i]] += vector[i];
+    }
+  }
+
+  // A rectangle of positive weight has a row with a positive entry in its columns, so only such rows need to be considered.
+
+  std::fill(_rowBound.begin(), _rowBound.end(), 0.0);
+  std::fill(_columnBound.begin(), _columnBound.end(), 0.0);
+  double maxRowBound = 0.0;
+  for (std::size_t r = 0; r < _rowEntries.size(); ++r)
+  {
+    if (_positiveByRow[r] <= 0.0)
+      continue;
+
+    for (std::size_t j = 0; j < _rowEntries[r].size(); ++j)
+      _rowBound[r] += _positiveByColumn[_columns[_rowEntries[r][j]]];
+    maxRowBound = std::max(maxRowBound, _rowBound[r]);
+  }
+  double maxColumnBound = 0.0;
+  for (std::size_t c = 0; c < _columnEntries.size(); ++c)
+  {
+    if (_positiveByColumn[c] <= 0.0)
+      continue;
+
+    for (std::size_t j = 0; j < _columnEntries[c].size(); ++j)
+      _columnBound[c] += _positiveByRow[_rows[_columnEntries[c][j]]];
+    maxColumnBound = std::max(maxColumnBound, _columnBound[c]);
+  }
+
+  return std::min(maxRowBound, maxColumnBound);
+}
+
+double MaximumWeightRectangleBound::crossBound(const double* vector, std::size_t workLimit)
+{
+  double bound = lineBound(vector);
+
+  // The cross of an entry is contained in its row's columns and in its column's rows, so both line bounds bound its weight.
+
+  _candidates.clear();
+  for (std::size_t i = 0; i < _rows.size(); ++i)
+  {
+    if (vector[i] > 0.0)
+      _candidates.push_back(std::make_pair(std::min(_rowBound[_rows[i]], _columnBound[_columns[i]]), i));
+  }
+  std::sort(_candidates.begin(), _candidates.end(), std::greater<std::pair<double, std::size_t> >());
+
+  double maxCross = 0.0;
+  std::size_t work = 0;
+  for (std::size_t k = 0; k < _candidates.size(); ++k)
+  {
+    if (_candidates[k].first <= maxCross)
+      return maxCross;
+
+    std::size_t entry = _candidates[k].second;
+    std::size_t column = _columns[entry];
+    work += _crossSize[column];
+    if (work > workLimit)
+      return std::min(bound, std::max(maxCross, _candidates[k].first));
+
+    // Sum up the positive entries in the rows of the column that lie in the columns of the row.
+
+    ++_currentMark;
+    const std::vector<std::size_t>& rowEntries = _rowEntries[_rows[entry]];
+    for (std::size_t j = 0; j < rowEntries.size(); ++j)
+      _columnMarks[_columns[rowEntries[j]]] = _currentMark;
+    double cross = 0.0;
+    for (std::size_t j = 0; j < _columnEntries[column].size(); ++j)
+    {
+      const std::vector<std::size_t>& entries = _rowEntries[_rows[_columnEntries[column][j]]];
+      for (std::size_t e = 0; e < entries.size(); ++e)
+      {
+        if (vector[entries[e]] > 0.0 && _columnMarks[_columns[entries[e]]] == _currentMark)
+          cross += vector[entries[e]];
+      }
+    }
+    maxCross = std::max(maxCross, cross);
+  }
+
+  return maxCross;
+}
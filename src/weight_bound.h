@@ -0,0 +1,54 @@
+#ifndef _WEIGHT_BOUND_H_
+#define _WEIGHT_BOUND_H_
+
+#include <vector>
+
+#include "slackmatrix.h"
+
+/**
+ * Certified upper bounds on the maximum weight of a rectangle for given weights of the nonzeros, which are much cheaper than an exact
+ * oracle. If U is such a bound, then the weight vector scaled by 1 / max(U, 1) satisfies all rectangle inequalities, and U - 1 bounds
+ * their maximum violation.
+ *
+ * Every rectangle lies in the columns of each of its rows, so its weight is at most the positive weight of the columns of some row,
+ * and likewise for rows of some column. A rectangle of positive weight moreover contains a positive entry and lies in the cross of its
+ * row and column, i.e., in the rows of the entry's column and the columns of the entry's row. The positive weights of these crosses
+ * are evaluated in the order of their line bounds until no remaining cross can exceed the heaviest one.
+ */
+
+class MaximumWeightRectangleBound
+{
+public:
+  MaximumWeightRectangleBound(const Slackmatrix& slackmatrix);
+
+  ~MaximumWeightRectangleBound();
+
+  /**
+   * Returns the line bound, which takes time linear in the number of nonzeros.
+   */
+
+  double lineBound(const double* vector);
+
+  /**
+   * Returns the cross bound, examining at most workLimit entries of crosses. If the limit is reached, the largest line bound of the
+   * unexamined crosses is returned, which is still valid.
+   */
+
+  double crossBound(const double* vector, std::size_t workLimit);
+
+protected:
+  std::vector<std::size_t> _rows;
+  std::vector<std::size_t> _columns;
+  std::vector<std::vector<std::size_t> > _rowEntries;
+  std::vector<std::vector<std::size_t> > _columnEntries;
+  std::vector<std::size_t> _crossSize;
+  std::vector<double> _positiveByRow;
+  std::vector<double> _positiveByColumn;
+  std::vector<double> _rowBound;
+  std::vector<double> _columnBound;
+  std::vector<std::size_t> _columnMarks;
+  std::size_t _currentMark;
+  std::vector<std::pair<double, std::size_t> > _candidates;
+};
+
+#endif /* _WEIGHT_BOUND_H_ */